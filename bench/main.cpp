@@ -0,0 +1,267 @@
+#include <algorithm>
+#include <awin/native_access.hpp>
+#include <awin/window.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#ifndef _WIN32
+    #include <awin/headless.hpp>
+#endif
+
+// Measures the hot paths of the library and prints the results as JSON:
+//   {"backend": "...", "results": [{"name": "...", "iterations": N, "ns_per_op": X, "min_ns_per_op": Y, ...}]}
+//
+// Usage: awin_bench [--backend auto|x11|wayland|headless] [--iterations N] [--output FILE]
+
+namespace
+{
+    struct Result
+    {
+        const char *name;
+        u64 iterations;
+        f64 ns_per_op;     // Median over all samples
+        f64 min_ns_per_op; // Best sample
+        f64 value;         // Benchmark-specific counter, negative when not used
+    };
+
+    struct Suite
+    {
+        acul::events::dispatcher *ed;
+        awin::Window *window;
+        u64 iterations;
+        acul::vector<Result> results;
+
+        static constexpr int samples = 5;
+
+        // Runs fn 'iterations' times per sample, each call counting as 'ops' operations
+        template <typename F>
+        void run(const char *name, u64 count, F &&fn, u64 ops = 1, f64 value = -1.0)
+        {
+            f64 timings[samples];
+            for (int s = 0; s < samples; ++s)
+            {
+                const auto begin = std::chrono::steady_clock::now();
+                for (u64 i = 0; i < count; ++i) fn();
+                const auto end = std::chrono::steady_clock::now();
+                timings[s] = std::chrono::duration<f64, std::nano>(end - begin).count() / static_cast<f64>(count * ops);
+            }
+            std::sort(timings, timings + samples);
+            results.push_back({name, count * ops, timings[samples / 2], timings[0], value});
+        }
+    };
+
+    template <typename T, typename... Args>
+    void bench_dispatch(Suite &suite, const char *name, u64 id, Args... args)
+    {
+        acul::events::event_group *group = nullptr;
+        acul::events::cache_event_group(id, group, suite.ed);
+        suite.run(name, suite.iterations, [&] { acul::events::dispatch_event_group<T>(group, args...); });
+    }
+
+    template <typename T>
+    void bind_sink(acul::events::dispatcher &ed, u64 *sink, u64 id)
+    {
+        ed.bind_event(sink, id, [sink](T &) { ++*sink; });
+    }
+
+    void bench_dispatch_all(Suite &suite)
+    {
+        using namespace awin;
+        awin::Window *window = suite.window;
+        bench_dispatch<FocusEvent>(suite, "dispatch.focus", event_id::focus, window, true);
+        bench_dispatch<CharInputEvent>(suite, "dispatch.char_input", event_id::char_input, window, u32('a'));
+        bench_dispatch<KeyInputEvent>(suite, "dispatch.key_input", event_id::key_input, window, io::Key::a,
+                                      io::KeyPressState::press, io::KeyMode{});
+        bench_dispatch<MouseClickEvent>(suite, "dispatch.mouse_click", event_id::mouse_click, window,
+                                        io::MouseKey::left, io::KeyPressState::press, io::KeyMode{});
+        bench_dispatch<MouseEnterEvent>(suite, "dispatch.mouse_enter", event_id::mouse_enter, window, true);
+        bench_dispatch<DeltaEvent>(suite, "dispatch.mouse_move_delta", event_id::mouse_move_delta, window,
+                                   acul::point2D<f64>(1.5, -0.5), acul::point2D<i32>(1, 0), u32(1));
+        bench_dispatch<PosEvent>(suite, "dispatch.mouse_move", event_id::mouse_move, event_id::mouse_move, window,
+                                 acul::point2D<i32>(10, 10), u32(1));
+        bench_dispatch<ScrollEvent>(suite, "dispatch.scroll", event_id::scroll, window, 0.0f, 1.0f);
+        bench_dispatch<DpiChangedEvent>(suite, "dispatch.dpi_changed", event_id::dpi_changed, window, 1.0f, 1.0f);
+        bench_dispatch<StateEvent>(suite, "dispatch.minimize", event_id::minimize, event_id::minimize, window, true);
+        bench_dispatch<StateEvent>(suite, "dispatch.maximize", event_id::maximize, event_id::maximize, window, true);
+        bench_dispatch<PosEvent>(suite, "dispatch.resize", event_id::resize, event_id::resize, window,
+                                 acul::point2D<i32>(640, 480), u32(1));
+        bench_dispatch<PosEvent>(suite, "dispatch.move", event_id::move, event_id::move, window,
+                                 acul::point2D<i32>(0, 0), u32(1));
+    }
+
+#ifndef _WIN32
+    // Full path through poll_events: synthetic events are queued and delivered by the headless backend.
+    void bench_injected(Suite &suite, const u64 &mouse_moves)
+    {
+        using namespace awin;
+        constexpr u64 frame_events = 64;
+        awin::Window &window = *suite.window;
+        const u64 frames = std::max<u64>(suite.iterations / frame_events, 1);
+
+        auto key_frame = [&] {
+            for (u64 i = 0; i < frame_events; ++i)
+                headless::inject_key(window, io::Key::a,
+                                     (i & 1) ? io::KeyPressState::release : io::KeyPressState::press);
+            poll_events();
+        };
+        suite.run("poll.key_input", frames, key_frame, frame_events);
+        set_event_batching(true);
+        suite.run("poll.key_input.batched", frames, key_frame, frame_events);
+        set_event_batching(false);
+
+        // Dispatch count and cost of a frame carrying 'frame_events' cursor motions, without and with coalescing
+        for (bool coalesce : {false, true})
+        {
+            set_event_coalescing(coalesce ? CoalesceBits::mouse_move : CoalesceBits::none);
+            const u64 before = mouse_moves;
+            auto frame = [&] {
+                for (u64 i = 0; i < frame_events; ++i)
+                    headless::inject_cursor_pos(window, {static_cast<i32>(i), static_cast<i32>(i)});
+                poll_events();
+            };
+            frame();
+            const f64 dispatched = static_cast<f64>(mouse_moves - before);
+            suite.run(coalesce ? "poll.mouse_move_frame.coalesced" : "poll.mouse_move_frame", frames, frame, 1,
+                      dispatched);
+        }
+        set_event_coalescing(CoalesceBits::none);
+    }
+#endif
+
+    int parse_backend(const char *name)
+    {
+        if (strcmp(name, "x11") == 0) return WINDOW_BACKEND_X11;
+        if (strcmp(name, "wayland") == 0) return WINDOW_BACKEND_WAYLAND;
+        if (strcmp(name, "headless") == 0) return WINDOW_BACKEND_HEADLESS;
+        return WINDOW_BACKEND_UNKNOWN;
+    }
+
+    const char *backend_name()
+    {
+#ifdef _WIN32
+        return "win32";
+#else
+        switch (awin::native_access::get_backend_type())
+        {
+            case WINDOW_BACKEND_X11:
+                return "x11";
+            case WINDOW_BACKEND_WAYLAND:
+                return "wayland";
+            case WINDOW_BACKEND_HEADLESS:
+                return "headless";
+            default:
+                return "unknown";
+        }
+#endif
+    }
+
+    void write_results(FILE *out, const Suite &suite)
+    {
+        fprintf(out, "{\n  \"backend\": \"%s\",\n  \"results\": [\n", backend_name());
+        for (size_t i = 0; i < suite.results.size(); ++i)
+        {
+            const Result &r = suite.results[i];
+            fprintf(out, "    {\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.3f, \"min_ns_per_op\": %.3f",
+                    r.name, static_cast<unsigned long long>(r.iterations), r.ns_per_op, r.min_ns_per_op);
+            if (r.value >= 0.0) fprintf(out, ", \"value\": %.3f", r.value);
+            fprintf(out, "}%s\n", i + 1 < suite.results.size() ? "," : "");
+        }
+        fprintf(out, "  ]\n}\n");
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    awin::InitConfig config;
+    u64 iterations = 100000;
+    const char *output = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--backend") == 0 && i + 1 < argc)
+            config.backend = parse_backend(argv[++i]);
+        else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+            iterations = std::max<u64>(strtoull(argv[++i], nullptr, 10), 1);
+        else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+            output = argv[++i];
+        else
+        {
+            fprintf(stderr, "Usage: %s [--backend auto|x11|wayland|headless] [--iterations N] [--output FILE]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    acul::events::dispatcher ed;
+    config.events_dispatcher = &ed;
+    awin::init_library(config);
+#ifdef AWIN_TEST_BUILD
+    if (awin::native_access::get_backend_type() == WINDOW_BACKEND_WAYLAND)
+        awin::native_access::enable_wayland_surface_placeholder();
+#endif
+
+    awin::Window window("awin_bench", 640, 480);
+    Suite suite{&ed, &window, iterations, {}};
+
+    u64 sinks[14] = {};
+    {
+        using namespace awin;
+        bind_sink<FocusEvent>(ed, &sinks[0], event_id::focus);
+        bind_sink<CharInputEvent>(ed, &sinks[1], event_id::char_input);
+        bind_sink<KeyInputEvent>(ed, &sinks[2], event_id::key_input);
+        bind_sink<MouseClickEvent>(ed, &sinks[3], event_id::mouse_click);
+        bind_sink<MouseEnterEvent>(ed, &sinks[4], event_id::mouse_enter);
+        bind_sink<DeltaEvent>(ed, &sinks[5], event_id::mouse_move_delta);
+        bind_sink<PosEvent>(ed, &sinks[6], event_id::mouse_move);
+        bind_sink<ScrollEvent>(ed, &sinks[7], event_id::scroll);
+        bind_sink<DpiChangedEvent>(ed, &sinks[8], event_id::dpi_changed);
+        bind_sink<StateEvent>(ed, &sinks[9], event_id::minimize);
+        bind_sink<StateEvent>(ed, &sinks[10], event_id::maximize);
+        bind_sink<PosEvent>(ed, &sinks[11], event_id::resize);
+        bind_sink<PosEvent>(ed, &sinks[12], event_id::move);
+        awin::update_events();
+    }
+
+    suite.run("get_time", iterations, [] {
+        volatile f64 t = awin::get_time();
+        (void)t;
+    });
+    suite.run("get_time_ns", iterations, [] {
+        volatile u64 t = awin::get_time_ns();
+        (void)t;
+    });
+    // Baseline for the clock calls above
+    suite.run("steady_clock.now", iterations, [] {
+        volatile auto t = std::chrono::steady_clock::now().time_since_epoch().count();
+        (void)t;
+    });
+    suite.run("poll_events.idle", iterations / 10 + 1, [] { awin::poll_events(); });
+    bench_dispatch_all(suite);
+#ifndef _WIN32
+    if (awin::native_access::get_backend_type() == WINDOW_BACKEND_HEADLESS) bench_injected(suite, sinks[6]);
+#endif
+
+    const acul::string clipboard_text = "awin_bench clipboard payload";
+    suite.run("clipboard.round_trip", iterations / 100 + 1, [&] {
+        awin::set_clipboard_string(window, clipboard_text);
+        volatile size_t size = awin::get_clipboard_string(window).size();
+        (void)size;
+    });
+
+    suite.run("window.create_destroy", iterations / 1000 + 1, [] {
+        awin::Window temp("awin_bench_temp", 320, 240, awin::WindowFlagBits::decorated | awin::WindowFlagBits::hidden);
+        temp.destroy();
+    });
+
+    window.destroy();
+    awin::destroy_library();
+
+    FILE *out = output ? fopen(output, "w") : stdout;
+    if (!out)
+    {
+        fprintf(stderr, "Failed to open %s\n", output);
+        return 1;
+    }
+    write_results(out, suite);
+    if (out != stdout) fclose(out);
+    return 0;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "software.hpp"
+#include "window.hpp"
+
+// Synthetic input for the headless backend (WINDOW_BACKEND_HEADLESS). Injected events are queued and delivered
+// by the next poll_events/wait_events call through the same path the native backends use.
+namespace awin::headless
+{
+#ifndef _WIN32
+    // Queue a keyboard event
+    APPLIB_API void inject_key(Window &window, io::Key key, io::KeyPressState action,
+                               io::KeyMode mods = io::KeyMode{});
+
+    // Queue a character input event
+    APPLIB_API void inject_char(Window &window, u32 char_code);
+
+    // Queue a mouse button event
+    APPLIB_API void inject_mouse_click(Window &window, io::MouseKey button, io::KeyPressState action,
+                                       io::KeyMode mods = io::KeyMode{});
+
+    // Queue the cursor entering or leaving the window
+    APPLIB_API void inject_mouse_enter(Window &window, bool entered);
+
+    // Queue a cursor motion in window coordinates
+    APPLIB_API void inject_cursor_pos(Window &window, acul::point2D<i32> position);
+
+    // Queue a raw cursor motion delta
+    APPLIB_API void inject_cursor_delta(Window &window, acul::point2D<f64> delta);
+
+    // Queue a scroll event
+    APPLIB_API void inject_scroll(Window &window, f32 h, f32 v);
+
+    // Queue a focus change
+    APPLIB_API void inject_focus(Window &window, bool focused);
+
+    // Queue a client area resize
+    APPLIB_API void inject_resize(Window &window, acul::point2D<i32> size);
+
+    // Queue the start or the end of an interactive resize
+    APPLIB_API void inject_live_resize(Window &window, bool active);
+
+    // Queue a window move
+    APPLIB_API void inject_move(Window &window, acul::point2D<i32> position);
+
+    // Queue a close request
+    APPLIB_API void inject_close(Window &window);
+
+    // Get the number of injected events waiting for the next poll cycle
+    APPLIB_API size_t pending_events();
+
+    // Get the pixels last presented by a software surface of the window, row by row without padding. Pixels outside
+    // the damage of a present keep their previous value. Empty until the first present, valid until the next one.
+    APPLIB_API std::span<const u32> get_presented_frame(const Window &window, acul::point2D<i32> *size = nullptr);
+#endif
+} // namespace awin::headless
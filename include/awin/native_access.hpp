@@ -18,6 +18,9 @@ namespace awin
 #else
         APPLIB_API int get_backend_type();
         APPLIB_API ::Window get_x11_window_handle(const Window &window);
+        // Number of X11 getter calls answered from the state tracked from events instead of a server round trip.
+        // Returns 0 when the X11 backend is not active.
+        APPLIB_API u64 get_x11_round_trips_avoided();
         APPLIB_API wl_surface *get_wayland_surface(const Window &window);
     #if defined(AWIN_TEST_BUILD) || defined(PROCESS_UNITTEST)
         APPLIB_API void enable_wayland_surface_placeholder();
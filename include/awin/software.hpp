@@ -0,0 +1,60 @@
+#pragma once
+
+#include <span>
+#include "window.hpp"
+
+// Presentation of CPU-rendered pixels without a GPU.
+//
+// A surface owns a ring of shared memory buffers in the size of the window: MIT-SHM images on X11 (plain images
+// sent over the connection when the server cannot share memory, for example over ssh), buffers of the wl_shm pool
+// on Wayland and a DIB section on Windows. The application draws into a buffer taken with acquire() and hands it to
+// the display server with present(), which only sends the damaged rectangles. A window presents either through a
+// software surface or through the GPU integration, not both.
+namespace awin
+{
+    // A rectangle of changed pixels in buffer coordinates
+    struct DamageRect
+    {
+        i32 x, y, width, height;
+    };
+
+    class APPLIB_API SoftwareSurface
+    {
+    public:
+        struct Platform;
+
+        // A buffer to draw the next frame into
+        struct Buffer
+        {
+            u32 *pixels;             // Premultiplied 0xAARRGGBB pixels, row by row
+            i32 stride;              // Distance between rows in pixels
+            acul::point2D<i32> size; // Size in pixels, follows the window size
+            u32 age; // Frames since the buffer was shown last: 1 if it holds the previous frame, 0 if undefined
+        };
+
+        // Create the buffers for the window. Two buffers give double buffering, three let the application draw the
+        // next frame while the server still reads the previous two. Wayland always uses at least two buffers, since
+        // the compositor may keep the shown one until it is replaced.
+        // The surface must be destroyed before its window.
+        explicit SoftwareSurface(Window &window, u32 buffer_count = 2);
+
+        SoftwareSurface(const SoftwareSurface &) = delete;
+        SoftwareSurface &operator=(const SoftwareSurface &) = delete;
+
+        ~SoftwareSurface();
+
+        // Check if the surface could be created
+        bool valid() const { return _pd != nullptr; }
+
+        // Take the buffer for the next frame. The buffers are recreated after the window was resized, their age is
+        // 0 then. Returns false while the display server still reads all buffers.
+        bool acquire(Buffer &buffer);
+
+        // Show the buffer taken by the last acquire. Only the damaged rectangles are sent, an empty list presents the
+        // whole buffer.
+        void present(std::span<const DamageRect> damage = {});
+
+    private:
+        Platform *_pd;
+    };
+} // namespace awin
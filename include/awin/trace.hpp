@@ -0,0 +1,80 @@
+#pragma once
+
+#include <acul/vector.hpp>
+#include "window.hpp"
+
+// Recording and deterministic replay of dispatched window events.
+//
+// A trace starts with a 8-byte header ("AWTR", u16 version, u16 reserved) followed by records of
+// { u8 kind, u8 window, f64 time, u32 server_time, payload }, where 'window' is the index of the window in the order
+// it was first seen, 'time' is the number of seconds since the recording started and 'server_time' is the display
+// server timestamp of input events, 0 for other events. Values are stored in native byte order.
+namespace awin::trace
+{
+    // Captures every event dispatched by the library while active.
+    class APPLIB_API Recorder
+    {
+    public:
+        Recorder() = default;
+        Recorder(const Recorder &) = delete;
+        Recorder &operator=(const Recorder &) = delete;
+
+        ~Recorder() { stop(); }
+
+        // Start capturing. Only one recorder can be active at a time, starting another one stops this one.
+        void start();
+
+        // Stop capturing. The recorded data is kept.
+        void stop();
+
+        // Check if the recorder is capturing events.
+        bool recording() const;
+
+        // Drop all recorded events.
+        void clear();
+
+        // Get the serialized trace
+        const acul::vector<u8> &data() const { return _data; }
+
+        // Write the trace to a file
+        bool save(const char *path) const;
+
+        // Append an event to the trace. Called by the library for each dispatched event.
+        void record(const acul::events::event &event);
+
+    private:
+        acul::vector<u8> _data;
+        acul::vector<Window *> _windows;
+        f64 _start = 0.0;
+    };
+
+    // Feeds a recorded trace back through the event listeners.
+    class APPLIB_API Replayer
+    {
+    public:
+        // Load a trace from a file
+        bool load(const char *path);
+
+        // Load a trace from memory
+        bool load(const acul::vector<u8> &data);
+
+        // Start the replay. Window indices of the trace are mapped onto 'windows', events of windows without a
+        // mapping are skipped. In realtime mode the original timing is kept, otherwise events are replayed as fast
+        // as update() is called.
+        void start(const acul::vector<Window *> &windows, bool realtime = true);
+
+        // Dispatch the events that are due: the ones recorded up to the elapsed replay time in realtime mode,
+        // all remaining ones otherwise. Returns false once the trace is exhausted.
+        bool update();
+
+        // Check if all events were replayed
+        bool finished() const { return _offset >= _data.size(); }
+
+    private:
+        acul::vector<u8> _data;
+        acul::vector<Window *> _windows;
+        size_t _offset = 0;
+        f64 _start = 0.0;
+        bool _realtime = true;
+    };
+} // namespace awin::trace
@@ -270,12 +270,84 @@ namespace awin
     WindowFlagBits::resizable | WindowFlagBits::minimize_box | WindowFlagBits::maximize_box | \
         WindowFlagBits::decorated | WindowFlagBits::NATIVE_RESERVE_FLAG
 
+    // Events that can be merged into a single event per window per poll cycle.
+    struct CoalesceBits
+    {
+        enum enum_type : u8
+        {
+            none = 0x0,
+            mouse_move = 0x1,       // Consecutive cursor motion is reported once with the latest position.
+            mouse_move_delta = 0x2, // Raw motion deltas are summed and reported once.
+            resize = 0x4,           // Window resizes are reported once with the final size.
+        };
+        using flag_bitmask = std::true_type;
+    };
+
+    using CoalesceFlags = acul::flags<CoalesceBits>;
+
     struct Image
     {
         acul::point2D<int> dimenstions;
         const void *pixels;
     };
 
+    // Input state of a window captured at the end of a poll cycle. Key sets are bitsets indexed by io::Key, button
+    // sets are bitmasks indexed by io::MouseKey.
+    struct InputSnapshot
+    {
+        static constexpr size_t key_words = (io::Key::last + 64) / 64;
+
+        u64 keys_down[key_words]{};             // Keys held down.
+        u64 keys_pressed[key_words]{};          // Keys pressed during the cycle.
+        u64 keys_released[key_words]{};         // Keys released during the cycle.
+        u64 keys_repeated[key_words]{};         // Keys repeated by the system during the cycle.
+        u8 buttons_down{0};                     // Mouse buttons held down.
+        u8 buttons_pressed{0};                  // Mouse buttons pressed during the cycle.
+        u8 buttons_released{0};                 // Mouse buttons released during the cycle.
+        acul::point2D<f32> scroll{0.0f, 0.0f};  // Scroll accumulated during the cycle.
+        acul::point2D<i32> cursor_pos{0, 0};    // Last reported cursor position.
+        io::KeyMode mods;                       // Modifiers of the last key or button event.
+
+        bool key_down(io::Key key) const { return test(keys_down, key); }
+        bool key_pressed(io::Key key) const { return test(keys_pressed, key); }
+        bool key_released(io::Key key) const { return test(keys_released, key); }
+        bool key_repeated(io::Key key) const { return test(keys_repeated, key); }
+        bool any_key_down() const { return any(keys_down); }
+        bool any_key_pressed() const { return any(keys_pressed); }
+
+        bool button_down(io::MouseKey button) const { return test(buttons_down, button); }
+        bool button_pressed(io::MouseKey button) const { return test(buttons_pressed, button); }
+        bool button_released(io::MouseKey button) const { return test(buttons_released, button); }
+
+        static bool test(const u64 *words, io::Key key)
+        {
+            return +key >= 0 && key <= io::Key::last && (words[key >> 6] >> (key & 63)) & 1;
+        }
+
+        static bool test(u8 mask, io::MouseKey button)
+        {
+            return button != io::MouseKey::unknown && (mask >> +button) & 1;
+        }
+
+        static bool any(const u64 *words)
+        {
+            u64 bits = 0;
+            for (size_t i = 0; i < key_words; ++i) bits |= words[i];
+            return bits != 0;
+        }
+    };
+
+    // Window state read through the accessors of Window
+    struct WindowState
+    {
+        acul::point2D<i32> dimensions{0, 0};
+        WindowFlags flags;
+        bool is_cursor_hidden{false};
+        bool focused{false};
+        bool ready_to_close{false};
+        acul::point2D<i32> resize_limit{0, 0};
+    };
+
     struct WindowData
     {
         Window *owner;
@@ -287,6 +359,31 @@ namespace awin
         acul::point2D<i32> resize_limit{0, 0};
         io::KeyPressState keys[io::Key::last + 1];
         Cursor *cursor{NULL};
+
+        // Events held back until the end of the current poll cycle
+        struct
+        {
+            acul::point2D<i32> cursor_pos;
+            u32 motion_count{0};
+            u32 motion_time{0};
+            acul::point2D<f64> delta{0.0, 0.0};
+            acul::point2D<f64> delta_remainder{0.0, 0.0}; // Sub-unit motion not yet reported as whole steps
+            u32 delta_count{0};
+            u32 delta_time{0};
+            acul::point2D<i32> size;
+            u32 resize_time{0};
+            bool resize_pending{false};
+            bool queued{false};
+        } deferred;
+        bool live_resize{false}; // An interactive resize is in progress.
+
+        InputSnapshot input;    // Input state collected during the current poll cycle.
+        InputSnapshot snapshot; // Input state published at the end of the last poll cycle.
+        bool input_queued{false};
+
+        // Copy of the state above owned by the polling thread when an event thread is used. The event thread
+        // publishes it along with the events, so it changes only when the next poll delivers them.
+        WindowState state;
     };
 } // namespace awin
 #endif
\ No newline at end of file
@@ -10,13 +10,18 @@
 
 #include <acul/event.hpp>
 #include <acul/log.hpp>
+#include <span>
 #include "types.hpp"
+#ifdef __linux__
+    #include <time.h>
+#endif
 
-#define WINDOW_BACKEND_UNKNOWN -1
-#define WINDOW_BACKEND_X11     0
-#define WINDOW_BACKEND_WAYLAND 1
-#define WINDOW_TIMEOUT_INF     -1
-#define WINDOW_DONT_CARE       -1
+#define WINDOW_BACKEND_UNKNOWN  -1
+#define WINDOW_BACKEND_X11      0
+#define WINDOW_BACKEND_WAYLAND  1
+#define WINDOW_BACKEND_HEADLESS 2
+#define WINDOW_TIMEOUT_INF      -1
+#define WINDOW_DONT_CARE        -1
 
 namespace awin
 {
@@ -38,16 +43,16 @@ namespace awin
         void title(const acul::string &title);
 
         // Returns the width of the window.
-        acul::point2D<i32> dimensions() const { return _data->dimenstions; }
+        acul::point2D<i32> dimensions() const;
 
         // Check if the window has decorations
-        inline bool decorated() const { return (_data->flags & WindowFlagBits::decorated) != 0; }
+        bool decorated() const;
 
         // Check if the window is resizable.
-        inline bool resizable() const { return (_data->flags & WindowFlagBits::resizable) != 0; }
+        bool resizable() const;
 
         // Check if the window is in fullscreen mode.
-        bool fullscreen() const { return (_data->flags & WindowFlagBits::fullscreen) != 0; }
+        bool fullscreen() const;
 
         // Enable fullscreen mode.
         void enable_fullscreen();
@@ -55,9 +60,14 @@ namespace awin
         // Disable fullscreen mode.
         void disable_fullscreen();
 
-        // Get the current cursor position.
+        // Get the current cursor position. On X11 this is the last position reported by the pointer events of the
+        // window, the server is only asked while the pointer is outside of it.
         acul::point2D<i32> cursor_position() const;
 
+        // Get the cursor position from the display server. On X11 this makes a round trip and refreshes the
+        // position returned by cursor_position(), elsewhere it is the same as cursor_position().
+        acul::point2D<i32> query_cursor_position() const;
+
         // Set the cursor position
         void cursor_position(acul::point2D<i32> position);
 
@@ -68,44 +78,40 @@ namespace awin
         void hide_cursor();
 
         // Check if the cursor is hidden.
-        inline bool is_cursor_hidden() const { return _data->is_cursor_hidden; }
+        bool is_cursor_hidden() const;
 
         // Set cursor
-        inline void set_cursor(Cursor *cursor) { _data->cursor = cursor; }
+        void set_cursor(Cursor *cursor);
 
         // Check if the window is focused.
-        inline bool focused() const { return _data->focused; }
+        bool focused() const;
 
         // Check if the window is minimized.
-        inline bool minimized() const { return _data->flags & WindowFlagBits::minimized; }
+        bool minimized() const;
 
         // Minimize the window
         void minimize();
 
         // Check if the window is maximized.
-        inline bool maximized() const { return _data->flags & WindowFlagBits::maximized; }
+        bool maximized() const;
 
         // Maximize the window
         void maximize();
 
         // Check if the window is hidden.
-        inline bool hidden() const { return _data->flags & awin::WindowFlagBits::hidden; }
+        bool hidden() const;
 
         // Get the window's resize limits.
-        inline acul::point2D<i32> resize_limit() const { return _data->resize_limit; }
+        acul::point2D<i32> resize_limit() const;
 
         // Set the window's resize limits.
-        void resize_limit(acul::point2D<i32> size)
-        {
-            _data->resize_limit = size;
-            update_resize_limit();
-        }
+        void resize_limit(acul::point2D<i32> size);
 
         // Check if the window is ready to be closed.
-        inline bool ready_to_close() const { return _data->ready_to_close; }
+        bool ready_to_close() const;
 
         // Change the window's ready-to-close state.
-        inline void ready_to_close(bool ready_to_close) { _data->ready_to_close = ready_to_close; }
+        void ready_to_close(bool ready_to_close);
 
         // Show the window if it is hidden.
         void show_window();
@@ -113,7 +119,8 @@ namespace awin
         // Hide the window
         void hide_window();
 
-        // Get current window position
+        // Get current window position. On X11 this is the position from the last ConfigureNotify, so a move
+        // requested by the application is seen once its event has been processed.
         acul::point2D<i32> position() const;
 
         // Set window position
@@ -130,6 +137,50 @@ namespace awin
         friend WindowData *get_window_data(const Window &);
     };
 
+    // A timer fired by poll_events/wait_events on the thread polling events, after the events of the cycle have been
+    // delivered. The waits return when an active timer expires, so the loop can sleep until its next frame, tick or
+    // autosave. A periodic timer that missed several periods fires once and keeps its phase. Timers must be used on
+    // the thread polling events.
+    class APPLIB_API Timer
+    {
+    public:
+        using Callback = void (*)(Timer &timer, void *user_data);
+
+        explicit Timer(Callback callback, void *user_data = nullptr) : _callback(callback), _user_data(user_data) {}
+
+        ~Timer() { stop(); }
+
+        Timer(const Timer &) = delete;
+        Timer &operator=(const Timer &) = delete;
+
+        // Fire once after the delay in seconds
+        void start_once(f64 delay);
+
+        // Fire every interval seconds, the first time one interval from now
+        void start_periodic(f64 interval);
+
+        // Stop the timer if it is active
+        void stop();
+
+        // Check if the timer is waiting to fire
+        bool active() const { return _active; }
+
+        // Get the time of the next expiration as a value of get_time()
+        f64 deadline() const { return _deadline; }
+
+    private:
+        Callback _callback;
+        void *_user_data;
+        f64 _deadline = 0.0;
+        f64 _interval = 0.0; // Zero for one-shot timers.
+        u64 _cycle = 0;      // Poll cycle of the last expiration.
+        bool _active = false;
+
+        void start(f64 delay, f64 interval);
+
+        friend void fire_timers();
+    };
+
     // Updates the event registry by associating different types of window events with their listeners.
     // This function gathers listeners for various event types like mouse clicks, keyboard input,
     // focus changes, etc., and registers them to corresponding events. This allows the system
@@ -159,8 +210,61 @@ namespace awin
 
         // A utility function responsible for processing keyboard input events specific to a particular window
         // implementation. It manages key presses, releases, and key modifiers, facilitating their propagation to the
-        // appropriate event handlers.
+        // appropriate event handlers. Cursor motion held back for the window is reported first.
         void input_key(WindowData *data, io::Key key, io::KeyPressState action, io::KeyMode mods);
+
+        // Reports a cursor motion. Depending on the coalescing flags the event is either dispatched right away or
+        // held back and merged with the following motion of the same window until the end of the poll cycle.
+        void input_cursor_pos(WindowData *data, acul::point2D<i32> position);
+
+        // Reports a raw (unaccelerated where available) cursor motion delta. Deltas are kept at full precision and,
+        // when coalescing is enabled, summed until the end of the poll cycle.
+        void input_cursor_delta(WindowData *data, acul::point2D<f64> delta);
+
+        // Dispatches a mouse button event. Any cursor motion held back for the window is reported first so that
+        // listeners always observe the position the click happened at.
+        void input_mouse_click(WindowData *data, io::MouseKey button, io::KeyPressState action,
+                               io::KeyMode mods = io::KeyMode{});
+
+        // Dispatches a scroll event and accumulates the offsets into the input snapshot of the window.
+        void input_scroll(WindowData *data, f32 h, f32 v);
+
+        // Dispatches the pointer entering or leaving the window, after any cursor motion held back for it.
+        void input_mouse_enter(WindowData *data, bool entered);
+
+        // Dispatches a focus change of the window, after any cursor motion held back for it.
+        void input_focus(WindowData *data, bool focused);
+
+        // Reports a new client area size. The caller has already stored it in the window data. With resize
+        // coalescing enabled, the event is held back until the end of the poll cycle and reports the final size.
+        void input_window_resize(WindowData *data, acul::point2D<i32> size);
+
+        // Reports the start or the end of an interactive resize. The end also dispatches the held-back resize.
+        void input_live_resize(WindowData *data, bool active);
+
+        // Dispatches the cursor motion held back for the window, if any.
+        void flush_cursor_pos(WindowData *data);
+
+        // Dispatches the raw motion delta accumulated for the window, if any.
+        void flush_cursor_delta(WindowData *data);
+
+        // Dispatches the resize held back for the window, if any.
+        void flush_window_resize(WindowData *data);
+
+        // Dispatches all events held back during the current poll cycle.
+        void flush_deferred_events();
+
+        // Delivers the events queued for batched delivery.
+        void deliver_batched_events();
+
+        // Publishes the input state collected during the poll cycle as the input snapshot of each window.
+        void publish_input_snapshots();
+
+        // Drops the events held back for the window. Must be called before the window data is released.
+        void discard_deferred_events(WindowData *data);
+
+        // Drops the events of the window queued for delivery and its pending input snapshot update.
+        void discard_queued_events(WindowData *data);
     } // namespace platform
 
     // Events
@@ -185,7 +289,9 @@ namespace awin
             minimize = 0x16AB16E6670A5AC2,
             maximize = 0x0A8C9013D84CEC08,
             resize = 0x1FB82ED0F4C701CB,
-            move = 0x2A5416AB994F5AAE
+            move = 0x2A5416AB994F5AAE,
+            live_resize = 0x2C7D4B19E6F03A85,
+            batch = 0x3C1E9F0A7D52B864
         };
     }; // namespace event_id
 
@@ -223,20 +329,29 @@ namespace awin
         }
     };
 
+    // Base of the input events. Carries the timing information used to measure input latency.
+    struct InputEvent : public acul::events::event
+    {
+        u32 server_time = 0;     // Display server timestamp in milliseconds, 0 if the platform provides none.
+        f64 dispatch_time = 0.0; // Value of get_time() when the event was dispatched.
+
+        explicit InputEvent(u64 id = 0) : event(id) {}
+    };
+
     // Represents a character input event in a window.
-    struct CharInputEvent : public acul::events::event
+    struct CharInputEvent : public InputEvent
     {
         awin::Window *window; // Pointer to the associated Window object.
         u32 char_code;        // Unicode character code.
 
         explicit CharInputEvent(awin::Window *window = nullptr, u32 char_code = 0)
-            : event(event_id::char_input), window(window), char_code(char_code)
+            : InputEvent(event_id::char_input), window(window), char_code(char_code)
         {
         }
     };
 
     // Represents a keyboard input event in a window.
-    struct KeyInputEvent : acul::events::event
+    struct KeyInputEvent : public InputEvent
     {
         awin::Window *window;     // Pointer to the associated Window object.
         io::Key key;              // The key involved in the event.
@@ -245,13 +360,13 @@ namespace awin
 
         explicit KeyInputEvent(awin::Window *window = nullptr, io::Key key = io::Key::unknown,
                                io::KeyPressState action = io::KeyPressState::release, io::KeyMode mods = io::KeyMode{})
-            : event(event_id::key_input), window(window), key(key), action(action), mods(mods)
+            : InputEvent(event_id::key_input), window(window), key(key), action(action), mods(mods)
         {
         }
     };
 
     // Represents a mouse click event in a window.
-    struct MouseClickEvent : public acul::events::event
+    struct MouseClickEvent : public InputEvent
     {
         awin::Window *window;     // Pointer to the associated Window object.
         io::MouseKey button;      // The mouse button involved in the event.
@@ -261,25 +376,27 @@ namespace awin
         explicit MouseClickEvent(awin::Window *window = nullptr, io::MouseKey button = io::MouseKey::unknown,
                                  io::KeyPressState action = io::KeyPressState::release,
                                  io::KeyMode mods = io::KeyMode{})
-            : event(event_id::mouse_click), window(window), button(button), action(action), mods(mods)
+            : InputEvent(event_id::mouse_click), window(window), button(button), action(action), mods(mods)
         {
         }
     };
 
     // Represents a mouse position event in a window. This one is dispatchted when the mouse enters or leaves the
     // window.
-    struct MouseEnterEvent : public acul::events::event
+    struct MouseEnterEvent : public InputEvent
     {
         awin::Window *window; // Pointer to the associated Window object.
         bool entered;         // Whether the mouse entered or left the window.
 
         explicit MouseEnterEvent(awin::Window *window = nullptr, bool entered = false)
-            : event(event_id::mouse_enter), window(window), entered(entered)
+            : InputEvent(event_id::mouse_enter), window(window), entered(entered)
         {
         }
     };
 
-    // Represents a window state change event in a window.
+    // Represents a window state change event in a window. Dispatched for minimize, maximize and live_resize, which
+    // reports the start (true) and the end (false) of an interactive resize where the platform signals it (Win32 and
+    // Wayland xdg-shell). Renderers can keep an oversized swapchain during the resize and rebuild it at the end.
     struct StateEvent : public acul::events::event
     {
         awin::Window *window; // Pointer to the associated Window object.
@@ -292,30 +409,69 @@ namespace awin
     };
 
     // Represents a position change event in a window.
-    struct PosEvent : public acul::events::event
+    struct PosEvent : public InputEvent
     {
         awin::Window *window;        // Pointer to the associated Window object.
         acul::point2D<i32> position; // The new position.
+        u32 count;                   // Number of native events merged into this one.
+
+        explicit PosEvent(u64 id = 0, awin::Window *window = nullptr, acul::point2D<i32> position = {},
+                          u32 count = 1)
+            : InputEvent(id), window(window), position(position), count(count)
+        {
+        }
+    };
 
-        explicit PosEvent(u64 id = 0, awin::Window *window = nullptr, acul::point2D<i32> position = {})
-            : event(id), window(window), position(position)
+    // Represents a relative cursor motion in a window.
+    struct DeltaEvent : public InputEvent
+    {
+        awin::Window *window;     // Pointer to the associated Window object.
+        acul::point2D<f64> delta; // Motion at full precision.
+        acul::point2D<i32> steps; // Whole units of motion. The fractional rest is carried to the next event.
+        u32 count;                // Number of native events merged into this one.
+
+        explicit DeltaEvent(awin::Window *window = nullptr, acul::point2D<f64> delta = {},
+                            acul::point2D<i32> steps = {}, u32 count = 1)
+            : InputEvent(event_id::mouse_move_delta), window(window), delta(delta), steps(steps), count(count)
         {
         }
     };
 
     // Represents a scroll event in a window.
-    struct ScrollEvent : public acul::events::event
+    struct ScrollEvent : public InputEvent
     {
         awin::Window *window; // Pointer to the associated Window object.
         f32 h;                // The Horizontal scroll value.
         f32 v;                // The Vertical scroll value.
 
         explicit ScrollEvent(awin::Window *window = nullptr, f32 hscroll = 0.0f, f32 vscroll = 0.0f)
-            : event(event_id::scroll), window(window), h(hscroll), v(vscroll)
+            : InputEvent(event_id::scroll), window(window), h(hscroll), v(vscroll)
         {
         }
     };
 
+    // Delivered to the listeners of event_id::batch once per poll cycle for each event type queued while batching is
+    // enabled. The listeners of the individual event types are called before the batch is delivered. Events of a
+    // window destroyed during the delivery are left out, or have a null window if a batch listener destroyed it.
+    struct EventBatch : public acul::events::event
+    {
+        u64 type;         // Identifier of the batched events.
+        const void *data; // The events, in the order they were received.
+        size_t size;      // Number of events.
+
+        explicit EventBatch(u64 type = event_id::unknown, const void *data = nullptr, size_t size = 0)
+            : event(event_id::batch), type(type), data(data), size(size)
+        {
+        }
+
+        // View the batch as the event type associated with 'type'
+        template <typename T>
+        std::span<const T> events() const
+        {
+            return {static_cast<const T *>(data), size};
+        }
+    };
+
     // Represents a DPI change event in a window.
     struct DpiChangedEvent : public acul::events::event
     {
@@ -327,9 +483,32 @@ namespace awin
         {
         }
     };
+#ifdef __linux__
+    namespace platform
+    {
+        // CLOCK_MONOTONIC value in nanoseconds at which get_time() is zero
+        extern APPLIB_API u64 time_offset_ns;
+    } // namespace platform
+
+    // Get the time elapsed since library initialization in integer nanoseconds, on the same clock as get_time().
+    // Inline on Linux: the monotonic clock is read through the vDSO and already counts nanoseconds.
+    inline u64 get_time_ns()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (u64)ts.tv_sec * 1'000'000'000 + (u64)ts.tv_nsec - platform::time_offset_ns;
+    }
+
+    // Get the time elapsed since library initialization in seconds as a floating-point value.
+    inline f64 get_time() { return (f64)get_time_ns() * 1e-9; }
+#else
     // Get the time elapsed since library initialization in seconds as a floating-point value.
     APPLIB_API f64 get_time();
 
+    // Get the time elapsed since library initialization in integer nanoseconds, on the same clock as get_time().
+    APPLIB_API u64 get_time_ns();
+#endif
+
     // Set the window library initialization time to the specified value in seconds.
     APPLIB_API void set_time(f64 time);
 
@@ -347,7 +526,8 @@ namespace awin
     // Processes all pending events in the event queue. This function checks the state
     // of all windows and other event sources, processes those events, and returns
     // control after all events have been processed. Typically used in an application's
-    // update loop to handle events as they occur.
+    // update loop to handle events as they occur. On Wayland it never waits for the compositor:
+    // requests that do not fit into a full connection are sent by later calls.
     APPLIB_API void poll_events();
 
     // Waits for new events to occur and processes them as soon as they appear.
@@ -361,16 +541,43 @@ namespace awin
     // within the given timeout period, the function returns. This is useful for
     // scenarios where you want to wait for events but also perform some other action
     // if no events occur within a certain time frame, such as updating the UI or
-    // handling non-event-related logic.
+    // handling non-event-related logic. The global timeout is left unchanged.
     APPLIB_API void wait_events_timeout();
 
+    // Waits for events until the deadline, a value of get_time(), and processes them. Returns without waiting
+    // if the deadline has already passed. Like the other waits, it also returns when an active Timer expires.
+    APPLIB_API void wait_events_until(f64 deadline);
+
     // Pushes an empty event to the event queue.
     APPLIB_API void push_empty_event();
 
+    // Hold back the requests of the window calls made until the matching end_batch, so that combined updates reach
+    // the display server in a single write. Batches can be nested, the outermost end_batch or the next event poll sends
+    // the requests.
+    // Only X11 buffers requests, elsewhere these do nothing.
+    APPLIB_API void begin_batch();
+    APPLIB_API void end_batch();
+
+    // Select the events merged into a single event per window per poll cycle. Nothing is merged by default.
+    APPLIB_API void set_event_coalescing(CoalesceFlags flags);
+
+    // Get the events currently merged per poll cycle.
+    APPLIB_API CoalesceFlags get_event_coalescing();
+
+    // Enable or disable batched delivery of input events. When enabled, input events are queued per type during
+    // the poll cycle and delivered type by type at its end, followed by one EventBatch per type. Disabled by default.
+    APPLIB_API void set_event_batching(bool enabled);
+
+    // Check if input events are delivered in batches.
+    APPLIB_API bool get_event_batching();
+
+    // Get the input state of the window as of the end of the last poll_events/wait_events call.
+    APPLIB_API const InputSnapshot &get_input_snapshot(const Window &window);
+
     // Retrieves the current dots per inch (DPI) value of the display.
     APPLIB_API f32 get_dpi(const Window &window);
 
-    // Get the client area size
+    // Get the client area size. On X11 this is the size from the last ConfigureNotify.
     APPLIB_API acul::point2D<i32> get_window_size(const Window &window);
 
     // Get text string from the clipboard buffer
@@ -384,6 +591,18 @@ namespace awin
         acul::events::dispatcher* events_dispatcher = nullptr;
         acul::log::log_service* log_service = nullptr;
         acul::log::logger_base* logger = nullptr;
+        // Linux: window backend to use. When unknown, it is detected from XDG_SESSION_TYPE.
+        int backend = WINDOW_BACKEND_UNKNOWN;
+        // Linux: run the backend on a dedicated thread that owns the display connection. Events are queued by that
+        // thread and delivered to the listeners by poll_events/wait_events on the calling thread, and the Window
+        // API calls are forwarded to it. The library must then be used from the calling thread only. The state
+        // accessors of Window read a copy the event thread publishes along with the events: a change is seen once
+        // the poll that delivers it has run, except for the values set through the setters of Window.
+        bool event_thread = false;
+        // Linux/X11: read events through XCB instead of the Xlib event queue, which lowers the per-event cost at
+        // high event rates. Input methods (XIM) need the Xlib queue and are not used in this mode, text input falls
+        // back to the keyboard layout. Ignored when libX11-xcb is not available.
+        bool xcb_events = false;
     };
 
     // Initialize the library.
@@ -394,6 +613,22 @@ namespace awin
 
 #ifndef _WIN32
     APPLIB_API void set_window_icon(Window &window, const acul::vector<Image> &images);
+
+    // Called by poll_events/wait_events on the polling thread when a watched descriptor is ready, after the events of
+    // the cycle have been delivered and before the timers fire. `revents` holds the poll events that occurred.
+    using FdWatchCallback = void (*)(int fd, i16 revents, void *user_data);
+
+    // Get a descriptor that becomes readable when there are events to process, to wait for them in an external
+    // epoll/io_uring loop. Call poll_events when it is readable and before waiting on it, as the display
+    // connection may already hold read events. Owned by the library and valid until destroy_library.
+    APPLIB_API int get_event_fd();
+
+    // Watch a descriptor for the poll events (POLLIN, POLLOUT, ...) while waiting for events, so wait_events and
+    // wait_events_timeout return when it is ready. Returns false if the descriptor is already watched.
+    APPLIB_API bool add_fd_watch(int fd, i16 events, FdWatchCallback callback, void *user_data = nullptr);
+
+    // Stop watching a descriptor
+    APPLIB_API void remove_fd_watch(int fd);
 #endif
 } // namespace awin
 
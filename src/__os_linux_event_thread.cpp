@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <cassert>
+#include "event_thread.hpp"
+#include "linux_pd.hpp"
+
+namespace awin
+{
+    namespace platform
+    {
+        static thread_local bool t_event_thread = false;
+
+        bool is_event_thread() { return t_event_thread; }
+
+        static void run_commands(EventThread *et)
+        {
+            Command command;
+            while (et->commands.pop(command)) command.invoke(command.ctx);
+        }
+
+        void wake_polling_thread() { signal_wake_event(g_env->event_thread->wake); }
+
+        void queue_thread_event(ThreadEvent &&event)
+        {
+            // The event thread never waits for the polling thread, which may itself be waiting for a command.
+            // Events that do not fit are kept in order in the overflow list until the queue has room again.
+            EventThread *et = g_env->event_thread;
+            if (et->overflow.empty() && et->events.push(event)) return;
+            et->overflow.push_back(std::move(event));
+            et->overflowed.store(true, std::memory_order_release);
+        }
+
+        static void flush_overflow(EventThread *et)
+        {
+            size_t moved = 0;
+            while (moved < et->overflow.size() && et->events.push(et->overflow[moved])) ++moved;
+            if (moved > 0) et->overflow.erase(et->overflow.begin(), et->overflow.begin() + moved);
+        }
+
+        // Queue the state of the windows that changed since it was last published. It follows the events produced
+        // before the change, so the polling thread sees both in the order they happened.
+        static void publish_window_states(EventThread *et)
+        {
+            for (auto &window : et->windows)
+            {
+                const WindowState state = capture_window_state(window.data);
+                if (same_window_state(state, window.state)) continue;
+                window.state = state;
+                queue_thread_event(WindowStateUpdate{window.data->owner, state});
+            }
+        }
+
+        static void event_thread_main(EventThread *et)
+        {
+            t_event_thread = true;
+            AWIN_LOG_INFO("Event thread started");
+            while (et->running.load(std::memory_order_acquire))
+            {
+                run_commands(et);
+                publish_window_states(et);
+                flush_overflow(et);
+                pd.pcall.wait_events();
+                flush_deferred_events();
+                publish_window_states(et);
+                flush_overflow(et);
+                if (!et->events.empty()) wake_polling_thread();
+            }
+            run_commands(et);
+            AWIN_LOG_INFO("Event thread stopped");
+        }
+
+        bool start_event_thread()
+        {
+            auto *et = acul::alloc<EventThread>();
+            if (!create_wake_event(et->wake))
+            {
+                acul::release(et);
+                return false;
+            }
+            g_env->event_thread = et;
+            et->polling_thread = std::this_thread::get_id();
+            et->thread = std::thread(event_thread_main, et);
+            return true;
+        }
+
+        void stop_event_thread()
+        {
+            EventThread *et = g_env->event_thread;
+            if (!et) return;
+            et->running.store(false, std::memory_order_release);
+            signal_wake_event(g_env->wake);
+            et->thread.join();
+            g_env->event_thread = nullptr;
+            destroy_wake_event(et->wake);
+            acul::release(et);
+        }
+
+        void submit_command(Command command)
+        {
+            EventThread *et = g_env->event_thread;
+            // The command queue has a single producer, calls from other threads would corrupt it
+            assert(std::this_thread::get_id() == et->polling_thread);
+            while (!et->commands.push(command)) std::this_thread::yield();
+            signal_wake_event(g_env->wake);
+        }
+
+        void deliver_thread_events()
+        {
+            EventThread *et = g_env->event_thread;
+            drain_wake_event(et->wake);
+
+            ThreadEvent event;
+            while (et->events.pop(event)) et->pending.push_back(event);
+            if (et->overflowed.exchange(false, std::memory_order_acq_rel)) signal_wake_event(g_env->wake);
+
+            // Listeners may destroy windows, which drops their entries and can append the rest of the queue,
+            // so the list is walked by index and each event is copied out before delivery
+            for (size_t i = 0; i < et->pending.size(); ++i)
+            {
+                event = et->pending[i];
+                std::visit(
+                    [](auto &e) {
+                        using T = std::decay_t<decltype(e)>;
+                        if constexpr (std::is_same_v<T, WindowStateUpdate>)
+                            get_window_data(*e.window)->state = e.state;
+                        else if constexpr (!std::is_same_v<T, std::monostate>)
+                            deliver_event(get_event_group(e.id), e);
+                    },
+                    event);
+            }
+            et->pending.clear();
+        }
+
+        void wait_thread_events(f64 *timeout)
+        {
+            EventThread *et = g_env->event_thread;
+            if (!et->pending.empty() || !et->events.empty()) return;
+            struct pollfd fds[] = {{et->wake.fd, POLLIN}};
+            bool watched;
+            poll_watched(fds, 1, timeout, watched);
+        }
+
+        static bool is_window_event(const ThreadEvent &event, Window *window)
+        {
+            return std::visit(
+                [window](const auto &e) {
+                    if constexpr (std::is_same_v<std::decay_t<decltype(e)>, std::monostate>)
+                        return false;
+                    else
+                        return e.window == window;
+                },
+                event);
+        }
+
+        void drop_thread_events(Window *window)
+        {
+            EventThread *et = g_env->event_thread;
+            if (!et) return;
+            ThreadEvent event;
+            while (et->events.pop(event)) et->pending.push_back(event);
+            for (auto &entry : et->pending)
+                if (is_window_event(entry, window)) entry = std::monostate{};
+        }
+
+        void track_window_state(WindowData *data)
+        {
+            EventThread *et = g_env->event_thread;
+            if (!et) return;
+            // The polling thread waits for the creation, so it reads the first state directly
+            data->state = capture_window_state(data);
+            et->windows.push_back({data, data->state});
+        }
+
+        void untrack_window_state(WindowData *data)
+        {
+            EventThread *et = g_env->event_thread;
+            if (!et) return;
+            auto &windows = et->windows;
+            windows.erase(std::remove_if(windows.begin(), windows.end(),
+                                         [data](const PublishedWindowState &window) { return window.data == data; }),
+                          windows.end());
+        }
+
+        void drop_overflow_events(Window *window)
+        {
+            EventThread *et = g_env->event_thread;
+            if (!et) return;
+            auto &overflow = et->overflow;
+            overflow.erase(std::remove_if(overflow.begin(), overflow.end(),
+                                          [window](const ThreadEvent &e) { return is_window_event(e, window); }),
+                           overflow.end());
+        }
+    } // namespace platform
+} // namespace awin
@@ -0,0 +1,46 @@
+#include <cerrno>
+#include <cstring>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include "env.hpp"
+
+namespace awin
+{
+    namespace platform
+    {
+        bool create_wake_event(WakeEvent &wake)
+        {
+            wake.fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (wake.fd == -1)
+            {
+                AWIN_LOG_ERROR("Failed to create wake event: %s", strerror(errno));
+                return false;
+            }
+            wake.pending.store(false, std::memory_order_relaxed);
+            return true;
+        }
+
+        void destroy_wake_event(WakeEvent &wake)
+        {
+            if (wake.fd == -1) return;
+            close(wake.fd);
+            wake.fd = -1;
+        }
+
+        void signal_wake_event(WakeEvent &wake)
+        {
+            // Only the first signal since the last drain reaches the kernel
+            if (wake.pending.exchange(true, std::memory_order_acq_rel)) return;
+            const u64 value = 1;
+            while (write(wake.fd, &value, sizeof(value)) == -1 && errno == EINTR) {}
+        }
+
+        void drain_wake_event(WakeEvent &wake)
+        {
+            // Cleared before reading, so a signal racing with the drain writes again and is not lost
+            wake.pending.store(false, std::memory_order_seq_cst);
+            u64 value;
+            while (read(wake.fd, &value, sizeof(value)) == -1 && errno == EINTR) {}
+        }
+    } // namespace platform
+} // namespace awin
@@ -1,7 +1,13 @@
 #include <X11/X.h>
+#include <algorithm>
 #include <acul/pair.hpp>
 #include <awin/native_access.hpp>
+#include <cmath>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
 #include "env.hpp"
+#include "event_thread.hpp"
+#include "headless/platform.hpp"
 #include "wayland/platform.hpp"
 #include "x11/platform.hpp"
 
@@ -9,19 +15,18 @@ namespace awin
 {
     namespace platform
     {
-        struct PlatformDataDispatcher
-        {
-            int backend_type;
-            LinuxPlatformCaller pcall;
-            LinuxWindowCaller wcall;
-            LinuxCursorCaller ccall;
-        } pd;
+        PlatformDataDispatcher pd;
+        u64 time_offset_ns = 0;
 
         void init_timer()
         {
-            g_env->timer.clock_id = CLOCK_REALTIME;
             g_env->timer.frequency = 1000000000;
-#if defined(_POSIX_MONOTONIC_CLOCK)
+#if defined(__linux__)
+            g_env->timer.clock_id = CLOCK_MONOTONIC;
+            g_env->timer.offset = get_time_value();
+#else
+            g_env->timer.clock_id = CLOCK_REALTIME;
+    #if defined(_POSIX_MONOTONIC_CLOCK)
             struct timespec ts;
             if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
             {
@@ -29,38 +34,59 @@ namespace awin
                 g_env->timer.offset = (u64)ts.tv_sec * 1'000'000'000 + ts.tv_nsec;
                 return;
             }
-#endif
+    #endif
             g_env->timer.offset = 0;
+#endif
         };
 
         void destroy_platform()
         {
+            if (g_env->event_fd != -1) close(g_env->event_fd);
+            if (g_env->timer_fd != -1) close(g_env->timer_fd);
             if (pd.backend_type != WINDOW_BACKEND_UNKNOWN) pd.pcall.destroy_platform();
+            destroy_wake_event(g_env->wake);
         };
 
         bool init_platform_caller()
         {
             pd.backend_type = WINDOW_BACKEND_UNKNOWN;
-            const char *xdg_session = getenv("XDG_SESSION_TYPE");
-            if (!xdg_session)
-                return false;
-            else if (strcmp(xdg_session, "wayland") == 0)
+            int backend = g_env->backend;
+            if (backend == WINDOW_BACKEND_UNKNOWN)
             {
-                platform::wayland::init_pcall_data(pd.pcall);
-                platform::wayland::init_wcall_data(pd.wcall);
-                platform::wayland::init_ccall_data(pd.ccall);
-                pd.backend_type = WINDOW_BACKEND_WAYLAND;
-                return true;
+                const char *xdg_session = getenv("XDG_SESSION_TYPE");
+                if (!xdg_session)
+                    return false;
+                else if (strcmp(xdg_session, "wayland") == 0)
+                    backend = WINDOW_BACKEND_WAYLAND;
+                else if (strcmp(xdg_session, "x11") == 0)
+                    backend = WINDOW_BACKEND_X11;
             }
-            else if (strcmp(xdg_session, "x11") == 0)
+
+            switch (backend)
             {
-                platform::x11::init_pcall_data(pd.pcall);
-                platform::x11::init_wcall_data(pd.wcall);
-                platform::x11::init_ccall_data(pd.ccall);
-                pd.backend_type = WINDOW_BACKEND_X11;
-                return true;
+                case WINDOW_BACKEND_WAYLAND:
+                    platform::wayland::init_pcall_data(pd.pcall);
+                    platform::wayland::init_wcall_data(pd.wcall);
+                    platform::wayland::init_ccall_data(pd.ccall);
+                    platform::wayland::init_scall_data(pd.scall);
+                    break;
+                case WINDOW_BACKEND_X11:
+                    platform::x11::init_pcall_data(pd.pcall);
+                    platform::x11::init_wcall_data(pd.wcall);
+                    platform::x11::init_ccall_data(pd.ccall);
+                    platform::x11::init_scall_data(pd.scall);
+                    break;
+                case WINDOW_BACKEND_HEADLESS:
+                    platform::headless::init_pcall_data(pd.pcall);
+                    platform::headless::init_wcall_data(pd.wcall);
+                    platform::headless::init_ccall_data(pd.ccall);
+                    platform::headless::init_scall_data(pd.scall);
+                    break;
+                default:
+                    return false;
             }
-            return false;
+            pd.backend_type = backend;
+            return true;
         }
 
         u64 get_time_frequency() { return g_env->timer.frequency; }
@@ -72,15 +98,22 @@ namespace awin
                 AWIN_LOG_ERROR("Unknown window backend");
                 return false;
             }
-            return pd.pcall.init_platform();
+            return create_wake_event(g_env->wake) && pd.pcall.init_platform();
         }
 
         u64 get_time_value()
         {
             struct timespec ts;
+#if defined(__linux__)
+            // A constant clock id keeps the vDSO fast path, which reads the TSC without entering the kernel when it
+            // is the clock source. The monotonic clock is always available on Linux.
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            return (u64)ts.tv_sec * 1'000'000'000 + (u64)ts.tv_nsec;
+#else
             if (clock_gettime(g_env->timer.clock_id, &ts) == 0)
                 return (u64)ts.tv_sec * g_env->timer.frequency + (u64)ts.tv_nsec;
             return 0;
+#endif
         }
 
         bool poll_posix(struct pollfd *fds, nfds_t count, f64 *timeout)
@@ -89,6 +122,9 @@ namespace awin
             {
                 if (timeout)
                 {
+                    // Loops that poll again after a ready descriptor can overrun the timeout, a negative value
+                    // would fail the poll or wait without limit
+                    if (*timeout < 0.0) *timeout = 0.0;
                     const u64 base = get_time_value();
 
 #if defined(__linux__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__CYGWIN__)
@@ -127,6 +163,116 @@ namespace awin
             }
         }
 
+        bool poll_watched(struct pollfd *fds, nfds_t count, f64 *timeout, bool &watched)
+        {
+            watched = false;
+            const auto &watches = g_env->fd_watches;
+            if ((watches.empty() && g_env->timer_fd == -1) || is_event_thread()) return poll_posix(fds, count, timeout);
+
+            auto &set = g_env->poll_set;
+            set.assign(fds, fds + count);
+            if (g_env->timer_fd != -1) set.push_back({g_env->timer_fd, POLLIN, 0});
+            for (const auto &watch : watches) set.push_back({watch.fd, watch.events, 0});
+            g_env->watches_polled = true;
+            if (!poll_posix(set.data(), set.size(), timeout)) return false;
+            for (nfds_t i = 0; i < count; ++i) fds[i].revents = set[i].revents;
+
+            // The expirations are consumed here, the timers are fired and the descriptor rearmed by fire_timers
+            if (g_env->timer_fd != -1 && set[count].revents)
+            {
+                u64 expirations;
+                while (read(g_env->timer_fd, &expirations, sizeof(expirations)) == -1 && errno == EINTR) {}
+            }
+
+            // Kept for dispatch_fd_watches, a wait may poll more than once before it returns
+            auto &ready = g_env->ready_watches;
+            for (size_t i = count + (g_env->timer_fd != -1); i < set.size(); ++i)
+            {
+                if (!set[i].revents) continue;
+                watched = true;
+                auto it = std::find_if(ready.begin(), ready.end(), [&](const auto &fd) { return fd.fd == set[i].fd; });
+                if (it != ready.end())
+                    it->revents |= set[i].revents;
+                else
+                    ready.push_back(set[i]);
+            }
+            return true;
+        }
+
+        void dispatch_fd_watches()
+        {
+            const auto &watches = g_env->fd_watches;
+            auto &ready = g_env->ready_watches;
+            const bool polled = g_env->watches_polled;
+            g_env->watches_polled = false;
+            if (watches.empty())
+            {
+                ready.clear();
+                return;
+            }
+
+            // A cycle that did not wait on the watches, like poll_events, checks them without blocking
+            if (!polled)
+            {
+                ready.clear();
+                for (const auto &watch : watches) ready.push_back({watch.fd, watch.events, 0});
+                if (poll(ready.data(), ready.size(), 0) <= 0)
+                {
+                    ready.clear();
+                    return;
+                }
+            }
+
+            // Callbacks may add or remove watches, so the watch is looked up again before each call
+            for (const auto &fd : ready)
+            {
+                if (!fd.revents) continue;
+                auto it = std::find_if(watches.begin(), watches.end(),
+                                       [&](const auto &watch) { return watch.fd == fd.fd; });
+                if (it != watches.end()) it->callback(fd.fd, fd.revents, it->user_data);
+            }
+            ready.clear();
+        }
+
+        static void add_event_source(int epoll_fd, int fd)
+        {
+            struct epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+            if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0)
+                AWIN_LOG_WARN("Failed to add descriptor %d to the event descriptor: %s", fd, strerror(errno));
+        }
+
+        void update_timers()
+        {
+            const f64 deadline = next_timer_deadline();
+            if (g_env->timer_fd == -1)
+            {
+                if (std::isinf(deadline)) return;
+                g_env->timer_fd = timerfd_create(g_env->timer.clock_id, TFD_NONBLOCK | TFD_CLOEXEC);
+                if (g_env->timer_fd == -1)
+                {
+                    AWIN_LOG_ERROR("Failed to create timer: %s", strerror(errno));
+                    return;
+                }
+                if (g_env->event_fd != -1) add_event_source(g_env->event_fd, g_env->timer_fd);
+            }
+
+            // Armed at the absolute deadline on the clock of get_time, rounded up so the descriptor never becomes
+            // readable before get_time reaches it. Rearming also resets the expiration count, a zero value disarms.
+            struct itimerspec spec{};
+            if (!std::isinf(deadline))
+            {
+                const f64 ticks = std::ceil(std::max(deadline, 0.0) * g_env->timer.frequency);
+                const u64 value = g_env->timer.offset + (u64)ticks;
+                spec.it_value.tv_sec = (time_t)(value / 1'000'000'000);
+                spec.it_value.tv_nsec = (long)(value % 1'000'000'000);
+                if (value == 0) spec.it_value.tv_nsec = 1;
+            }
+            if (timerfd_settime(g_env->timer_fd, TFD_TIMER_ABSTIME, &spec, NULL) != 0)
+                AWIN_LOG_ERROR("Failed to arm timer: %s", strerror(errno));
+        }
+
         void sync_mods_by_key(io::Key key, io::KeyMode &mods)
         {
             switch (key)
@@ -157,103 +303,315 @@ namespace awin
 
     Cursor::Platform::~Platform()
     {
-        if (platform::pd.ccall.destroy) platform::pd.ccall.destroy(this);
+        if (platform::pd.ccall.destroy) platform::run_command([this] { platform::pd.ccall.destroy(this); });
     }
 
-    bool Cursor::valid() const { return platform::pd.ccall.valid(_pd); }
+    bool Cursor::valid() const
+    {
+        return platform::run_command([this] { return platform::pd.ccall.valid(_pd); });
+    }
 
-    MonitorInfo get_primary_monitor_info() { return platform::pd.pcall.get_primary_monitor_info(); }
+    SoftwareSurface::SoftwareSurface(Window &window, u32 buffer_count) : _pd(nullptr)
+    {
+        if (!platform::pd.scall.create)
+        {
+            AWIN_LOG_ERROR("The window backend does not support software surfaces");
+            return;
+        }
+        WindowData *data = get_window_data(window);
+        buffer_count = std::clamp(buffer_count, 1U, 3U);
+        _pd = platform::run_command([data, buffer_count] { return platform::pd.scall.create(data, buffer_count); });
+    }
+
+    SoftwareSurface::~SoftwareSurface()
+    {
+        if (_pd) platform::run_command([this] { platform::pd.scall.destroy(_pd); });
+    }
+
+    bool SoftwareSurface::acquire(Buffer &buffer)
+    {
+        if (!_pd) return false;
+        return platform::run_command([&] { return platform::pd.scall.acquire(_pd, buffer); });
+    }
+
+    void SoftwareSurface::present(std::span<const DamageRect> damage)
+    {
+        if (!_pd || _pd->acquired < 0) return;
+        platform::run_command([&] { platform::pd.scall.present(_pd, damage); });
+    }
+
+    MonitorInfo get_primary_monitor_info()
+    {
+        return platform::run_command([] { return platform::pd.pcall.get_primary_monitor_info(); });
+    }
 
     Window::Window(const acul::string &title, i32 width, i32 height, WindowFlags flags)
-        : _data(platform::pd.pcall.alloc_window_data())
+        : _data(platform::run_command([] { return platform::pd.pcall.alloc_window_data(); }))
     {
         _data->owner = this;
-        if (!platform::pd.wcall.create_window(_data, title, width, height, flags))
-            throw acul::runtime_error("Failed to create Window");
+        const bool created = platform::run_command([&] {
+            if (!platform::pd.wcall.create_window(_data, title, width, height, flags)) return false;
+            platform::track_window_state(_data);
+            return true;
+        });
+        if (!created) throw acul::runtime_error("Failed to create Window");
     }
 
-    void Window::destroy() { platform::pd.wcall.destroy(_data); }
+    void Window::destroy()
+    {
+        platform::discard_queued_events(_data);
+        platform::run_command([this] {
+            platform::discard_deferred_events(_data);
+            platform::pd.wcall.destroy(_data);
+            platform::drop_overflow_events(this);
+            platform::untrack_window_state(_data);
+        });
+        platform::drop_thread_events(this);
+    }
 
     void Window::show_window()
     {
-        if (!hidden()) return;
-        _data->flags &= ~WindowFlagBits::hidden;
-        platform::pd.wcall.show_window(_data);
+        platform::post_command([data = _data] {
+            if (!(data->flags & WindowFlagBits::hidden)) return;
+            data->flags &= ~WindowFlagBits::hidden;
+            platform::pd.wcall.show_window(data);
+        });
     }
 
     void Window::hide_window()
     {
-        if (hidden()) return;
-        platform::pd.wcall.hide_window(_data);
-        _data->flags |= WindowFlagBits::hidden;
+        platform::post_command([data = _data] {
+            if (data->flags & WindowFlagBits::hidden) return;
+            platform::pd.wcall.hide_window(data);
+            data->flags |= WindowFlagBits::hidden;
+        });
     }
 
-    acul::string Window::title() const { return platform::pd.wcall.get_window_title(_data); }
+    acul::string Window::title() const
+    {
+        return platform::run_command([this] { return platform::pd.wcall.get_window_title(_data); });
+    }
 
-    void Window::title(const acul::string &title) { platform::pd.wcall.set_window_title(_data, title); }
+    void Window::title(const acul::string &title)
+    {
+        platform::post_command([data = _data, title] { platform::pd.wcall.set_window_title(data, title); });
+    }
 
     void Window::enable_fullscreen()
     {
-        _data->flags |= WindowFlagBits::fullscreen;
-        platform::pd.wcall.enable_fullscreen(_data);
+        platform::post_command([data = _data] {
+            data->flags |= WindowFlagBits::fullscreen;
+            platform::pd.wcall.enable_fullscreen(data);
+        });
     }
 
     void Window::disable_fullscreen()
     {
-        _data->flags &= ~WindowFlagBits::fullscreen;
-        platform::pd.wcall.disable_fullscreen(_data);
+        platform::post_command([data = _data] {
+            data->flags &= ~WindowFlagBits::fullscreen;
+            platform::pd.wcall.disable_fullscreen(data);
+        });
     }
 
-    acul::point2D<i32> Window::cursor_position() const { return platform::pd.wcall.get_cursor_position(_data); }
+    acul::point2D<i32> Window::cursor_position() const
+    {
+        return platform::run_command([this] { return platform::pd.wcall.get_cursor_position(_data); });
+    }
+
+    acul::point2D<i32> Window::query_cursor_position() const
+    {
+        return platform::run_command([this] { return platform::pd.wcall.query_cursor_position(_data); });
+    }
 
     void Window::cursor_position(acul::point2D<i32> position)
     {
-        platform::pd.wcall.set_cursor_position(_data, position);
+        platform::post_command([data = _data, position] { platform::pd.wcall.set_cursor_position(data, position); });
     }
 
-    void Window::hide_cursor() { platform::pd.wcall.hide_cursor(_data); }
+    void Window::hide_cursor()
+    {
+        platform::post_command([data = _data] { platform::pd.wcall.hide_cursor(data); });
+    }
 
-    void Window::show_cursor() { platform::pd.wcall.show_cursor(this, _data); }
+    void Window::show_cursor()
+    {
+        platform::post_command([this] { platform::pd.wcall.show_cursor(this, _data); });
+    }
 
-    acul::point2D<i32> Window::position() const { return platform::pd.wcall.get_window_position(_data); }
+    acul::point2D<i32> Window::position() const
+    {
+        return platform::run_command([this] { return platform::pd.wcall.get_window_position(_data); });
+    }
 
-    void Window::position(acul::point2D<i32> position) { platform::pd.wcall.set_window_position(_data, position); }
+    void Window::position(acul::point2D<i32> position)
+    {
+        platform::post_command([data = _data, position] { platform::pd.wcall.set_window_position(data, position); });
+    }
 
-    void Window::center_window() { platform::pd.wcall.center_window(_data); }
+    void Window::center_window()
+    {
+        platform::post_command([data = _data] { platform::pd.wcall.center_window(data); });
+    }
 
-    void Window::update_resize_limit() { platform::pd.wcall.update_resize_limit(_data); }
+    void Window::update_resize_limit()
+    {
+        platform::post_command([data = _data] { platform::pd.wcall.update_resize_limit(data); });
+    }
 
-    void Window::minimize() { platform::pd.wcall.minimize_window(_data); }
+    void Window::minimize()
+    {
+        platform::post_command([data = _data] { platform::pd.wcall.minimize_window(data); });
+    }
 
-    void Window::maximize() { platform::pd.wcall.maximize_window(_data); }
+    void Window::maximize()
+    {
+        platform::post_command([data = _data] { platform::pd.wcall.maximize_window(data); });
+    }
 
-    void poll_events() { platform::pd.pcall.poll_events(); }
+    // Hands the events of the cycle to the listeners and publishes the input snapshots, then runs the descriptor
+    // watches and timers
+    static void end_poll_cycle()
+    {
+        if (platform::g_env->event_thread)
+            platform::deliver_thread_events();
+        else
+            platform::flush_deferred_events();
+        platform::deliver_batched_events();
+        platform::publish_input_snapshots();
+        platform::dispatch_fd_watches();
+        fire_timers();
+    }
 
-    void wait_events() { platform::pd.pcall.wait_events(); }
+    void poll_events()
+    {
+        if (!platform::g_env->event_thread) platform::pd.pcall.poll_events();
+        end_poll_cycle();
+    }
 
-    void wait_events_timeout() { platform::pd.pcall.wait_events_timeout(); }
+    void wait_events()
+    {
+        if (platform::g_env->event_thread)
+            platform::wait_thread_events(NULL);
+        else
+            platform::pd.pcall.wait_events();
+        end_poll_cycle();
+    }
 
-    void push_empty_event() { platform::pd.pcall.push_empty_event(); }
+    void wait_events_timeout()
+    {
+        const f64 timeout = platform::g_env->timeout;
+        if (timeout > WINDOW_TIMEOUT_INF)
+            wait_events_until(get_time() + timeout);
+        else
+            wait_events();
+    }
 
-    f32 get_dpi(const Window &window) { return platform::pd.pcall.get_dpi(get_window_data(window)); }
+    void wait_events_until(f64 deadline)
+    {
+        f64 timeout = deadline - get_time();
+        if (timeout > 0.0)
+        {
+            if (platform::g_env->event_thread)
+                platform::wait_thread_events(&timeout);
+            else
+                platform::pd.pcall.wait_events_timeout(timeout);
+        }
+        else if (!platform::g_env->event_thread)
+            platform::pd.pcall.poll_events();
+        end_poll_cycle();
+    }
+
+    void push_empty_event()
+    {
+        if (platform::g_env->event_thread)
+            platform::wake_polling_thread();
+        else
+            platform::signal_wake_event(platform::g_env->wake);
+    }
+
+    void begin_batch()
+    {
+        if (platform::pd.pcall.begin_batch) platform::post_command([] { platform::pd.pcall.begin_batch(); });
+    }
+
+    void end_batch()
+    {
+        if (platform::pd.pcall.end_batch) platform::post_command([] { platform::pd.pcall.end_batch(); });
+    }
+
+    int get_event_fd()
+    {
+        auto *env = platform::g_env;
+        if (env->event_fd != -1) return env->event_fd;
+
+        const int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd == -1)
+        {
+            AWIN_LOG_ERROR("Failed to create event descriptor: %s", strerror(errno));
+            return -1;
+        }
+        acul::vector<int> fds;
+        if (env->event_thread)
+            fds.push_back(env->event_thread->wake.fd);
+        else
+            platform::pd.pcall.get_event_fds(fds);
+        if (env->timer_fd != -1) fds.push_back(env->timer_fd);
+        for (int fd : fds) platform::add_event_source(epoll_fd, fd);
+        env->event_fd = epoll_fd;
+        return epoll_fd;
+    }
 
-    acul::point2D<i32> get_window_size(const Window &window) { return platform::pd.pcall.get_window_size(window); }
+    bool add_fd_watch(int fd, i16 events, FdWatchCallback callback, void *user_data)
+    {
+        auto &watches = platform::g_env->fd_watches;
+        for (const auto &watch : watches)
+            if (watch.fd == fd) return false;
+        watches.push_back({fd, events, callback, user_data});
+        return true;
+    }
 
-    acul::string get_clipboard_string(const Window &window) { return platform::pd.pcall.get_clipboard_string(); }
+    void remove_fd_watch(int fd)
+    {
+        auto &watches = platform::g_env->fd_watches;
+        auto it = std::find_if(watches.begin(), watches.end(), [fd](const auto &watch) { return watch.fd == fd; });
+        if (it != watches.end()) watches.erase(it);
+    }
+
+    f32 get_dpi(const Window &window)
+    {
+        return platform::run_command([&window] { return platform::pd.pcall.get_dpi(get_window_data(window)); });
+    }
+
+    acul::point2D<i32> get_window_size(const Window &window)
+    {
+        return platform::run_command([&window] { return platform::pd.pcall.get_window_size(window); });
+    }
+
+    acul::string get_clipboard_string(const Window &window)
+    {
+        return platform::run_command([] { return platform::pd.pcall.get_clipboard_string(); });
+    }
 
     void set_clipboard_string(const Window &window, const acul::string &text)
     {
-        platform::pd.pcall.set_clipboard_string(text);
+        platform::post_command([text] { platform::pd.pcall.set_clipboard_string(text); });
     }
 
     void set_window_icon(Window &window, const acul::vector<Image> &images)
     {
-        platform::pd.wcall.set_window_icon(get_window_data(window), images);
+        // The images reference caller memory, so the call waits for the event thread
+        platform::run_command([&] { platform::pd.wcall.set_window_icon(get_window_data(window), images); });
     }
 
     int native_access::get_backend_type() { return platform::pd.backend_type; }
 
-    Cursor Cursor::create(Type type) { return {platform::pd.ccall.create(type)}; }
+    Cursor Cursor::create(Type type)
+    {
+        return {platform::run_command([type] { return platform::pd.ccall.create(type); })};
+    }
 
-    void Cursor::assign(Window *window) { platform::pd.ccall.assign(window, _pd); }
+    void Cursor::assign(Window *window)
+    {
+        platform::post_command([window, cursor = _pd] { platform::pd.ccall.assign(window, cursor); });
+    }
 } // namespace awin
@@ -1,6 +1,9 @@
 #include <acul/string/string.hpp>
+#include <algorithm>
 #include <awin/native_access.hpp>
+#include <awin/software.hpp>
 #include <awin/window.hpp>
+#include <cmath>
 #include <shlobj.h>
 #include <windef.h>
 #include <windowsx.h>
@@ -29,6 +32,7 @@ namespace awin
             WCHAR high_surrogate;
             acul::point2D<i32> saved_cursor_pos{0, 0};
             bool cursor_tracked{false};
+            bool size_move{false}; // Inside the modal move/resize loop.
             bool raw_input{false};
             LPBYTE raw_input_data{nullptr};
             UINT raw_input_size{0};
@@ -82,7 +86,7 @@ namespace awin
         {
             if (!wd) return;
             wd->focused = false;
-            acul::events::dispatch_event_group<FocusEvent>(g_env->events.focus, wd->owner, false);
+            input_focus(wd, false);
             if (!wd->raw_input) return;
             const RAWINPUTDEVICE rid = {0x01, 0x02, RIDEV_REMOVE, NULL};
             if (!RegisterRawInputDevices(&rid, 1, sizeof(rid)))
@@ -251,8 +255,7 @@ namespace awin
                             action = io::KeyPressState::release;
                             break;
                     };
-                    acul::events::dispatch_event_group<awin::MouseClickEvent>(events.mouse_click, window->owner, button,
-                                                                              action);
+                    input_mouse_click(window, button, action);
                     break;
                 }
                 case WM_WINDOWPOSCHANGED:
@@ -264,7 +267,7 @@ namespace awin
                 case WM_SETFOCUS:
                 {
                     window->focused = true;
-                    acul::events::dispatch_event_group<FocusEvent>(events.focus, window->owner, true);
+                    input_focus(window, true);
                     const RAWINPUTDEVICE rid = {0x01, 0x02, RIDEV_INPUTSINK, hwnd};
                     if (!RegisterRawInputDevices(&rid, 1, sizeof(rid)))
                         AWIN_LOG_ERROR("[Win32] Failed to register raw input device. Error code: %lu", GetLastError());
@@ -286,12 +289,11 @@ namespace awin
                         {
                             u32 codepoint = (((window->high_surrogate - 0xD800) << 10) | (wParam - 0xDC00)) + 0x10000;
                             window->high_surrogate = 0;
-                            acul::events::dispatch_event_group<CharInputEvent>(events.char_input, window->owner,
-                                                                               codepoint);
+                            dispatch_event<CharInputEvent>(events.char_input, window->owner, codepoint);
                         }
                     }
                     else
-                        acul::events::dispatch_event_group<CharInputEvent>(events.char_input, window->owner, wParam);
+                        dispatch_event<CharInputEvent>(events.char_input, window->owner, wParam);
 
                     if (uMsg == WM_SYSCHAR) break;
                     return 0;
@@ -306,7 +308,7 @@ namespace awin
                         // Returning TRUE here announces support for this message
                         return TRUE;
                     }
-                    acul::events::dispatch_event_group<CharInputEvent>(events.char_input, window->owner, wParam);
+                    dispatch_event<CharInputEvent>(events.char_input, window->owner, wParam);
                     return 0;
                 }
                 case WM_SYSCOMMAND:
@@ -412,27 +414,23 @@ namespace awin
                         tme.hwndTrack = window->hwnd;
                         TrackMouseEvent(&tme);
                         window->cursor_tracked = true;
-                        acul::events::dispatch_event_group<MouseEnterEvent>(events.mouse_enter, window->owner, true);
+                        input_mouse_enter(window, true);
                     }
-                    acul::events::dispatch_event_group<PosEvent>(
-                        events.mouse_move, event_id::mouse_move, window->owner,
-                        acul::point2D(GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam)));
+                    input_cursor_pos(window, acul::point2D(GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam)));
                     return 0;
                 }
                 case WM_MOUSELEAVE:
                     window->cursor_tracked = false;
-                    acul::events::dispatch_event_group<MouseEnterEvent>(events.mouse_enter, window->owner, false);
+                    input_mouse_enter(window, false);
                     return 0;
                 case WM_MOUSEWHEEL:
-                    acul::events::dispatch_event_group<ScrollEvent>(events.scroll, window->owner, 0,
-                                                                    (SHORT)HIWORD(wParam) / (f64)WHEEL_DELTA);
+                    input_scroll(window, 0, (SHORT)HIWORD(wParam) / (f32)WHEEL_DELTA);
                     return 0;
                 case WM_MOUSEHWHEEL:
                 {
                     // This message is only sent on Windows Vista and later
                     // NOTE: The X-axis is inverted for consistency with macOS and X11
-                    acul::events::dispatch_event_group<ScrollEvent>(events.scroll, window->owner,
-                                                                    -((SHORT)HIWORD(wParam) / (f64)WHEEL_DELTA), 0);
+                    input_scroll(window, -((SHORT)HIWORD(wParam) / (f32)WHEEL_DELTA), 0);
                     return 0;
                 }
                 case WM_SIZE:
@@ -451,8 +449,7 @@ namespace awin
                             }
                             else
                                 window->flags &= ~WindowFlagBits::minimized;
-                            acul::events::dispatch_event_group<StateEvent>(events.minimize, event_id::minimize,
-                                                                           window->owner, want_min);
+                            dispatch_event<StateEvent>(events.minimize, event_id::minimize, window->owner, want_min);
                         }
                         if ((window->flags & WindowFlagBits::maximized) != want_max)
                         {
@@ -460,22 +457,27 @@ namespace awin
                                 window->flags |= WindowFlagBits::maximized;
                             else
                                 window->flags &= ~WindowFlagBits::maximized;
-                            acul::events::dispatch_event_group<StateEvent>(events.maximize, event_id::maximize,
-                                                                           window->owner, want_max);
+                            dispatch_event<StateEvent>(events.maximize, event_id::maximize, window->owner, want_max);
                         }
                     }
                     if (dimenstions != window->dimenstions)
                     {
                         window->dimenstions = dimenstions;
-                        acul::events::dispatch_event_group<PosEvent>(events.resize, event_id::resize, window->owner,
-                                                                     dimenstions);
+                        if (window->size_move) input_live_resize(window, true);
+                        input_window_resize(window, dimenstions);
                     }
                     return 0;
                 }
+                case WM_ENTERSIZEMOVE:
+                    window->size_move = true;
+                    break;
+                case WM_EXITSIZEMOVE:
+                    window->size_move = false;
+                    input_live_resize(window, false);
+                    break;
                 case WM_MOVE:
-                    acul::events::dispatch_event_group<PosEvent>(
-                        events.move, event_id::move, window->owner,
-                        acul::point2D(GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam)));
+                    dispatch_event<PosEvent>(events.move, event_id::move, window->owner,
+                                             acul::point2D(GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam)));
                     break;
                 case WM_GETMINMAXINFO:
                 {
@@ -489,8 +491,7 @@ namespace awin
                 {
                     const float xscale = HIWORD(wParam) / 96.0f;
                     const float yscale = LOWORD(wParam) / 96.0f;
-                    acul::events::dispatch_event_group<DpiChangedEvent>(events.dpi_changed, window->owner, xscale,
-                                                                        yscale);
+                    dispatch_event<DpiChangedEvent>(events.dpi_changed, window->owner, xscale, yscale);
                     break;
                 }
                 case WM_SETCURSOR:
@@ -526,9 +527,8 @@ namespace awin
 
                     if (raw->header.dwType == RIM_TYPEMOUSE)
                     {
-                        acul::point2D<i32> delta{raw->data.mouse.lLastX, raw->data.mouse.lLastY};
-                        acul::events::dispatch_event_group<PosEvent>(events.mouse_move_delta,
-                                                                     event_id::mouse_move_delta, window->owner, delta);
+                        input_cursor_delta(window, {static_cast<f64>(raw->data.mouse.lLastX),
+                                                    static_cast<f64>(raw->data.mouse.lLastY)});
                     }
                     return 0;
                 }
@@ -556,6 +556,9 @@ namespace awin
 
         void init_timer() { QueryPerformanceFrequency((LARGE_INTEGER *)&g_env->timer.frequency); }
 
+        // Timers are covered by the timeout of the message wait
+        void update_timers() {}
+
         u64 get_time_value()
         {
             u64 value;
@@ -636,6 +639,8 @@ namespace awin
     void Window::destroy()
     {
         auto *wd = (platform::Win32WindowData *)_data;
+        platform::discard_deferred_events(_data);
+        platform::discard_queued_events(_data);
         if (wd->raw_input_data)
         {
             acul::release(wd->raw_input_data);
@@ -715,6 +720,8 @@ namespace awin
         return {};
     }
 
+    acul::point2D<i32> Window::query_cursor_position() const { return cursor_position(); }
+
     void Window::cursor_position(acul::point2D<i32> position)
     {
         auto *wd = (platform::Win32WindowData *)_data;
@@ -800,9 +807,22 @@ namespace awin
         ShowWindow(wd->hwnd, maximized() ? SW_RESTORE : SW_MAXIMIZE);
     }
 
+    // Waits for a message until the deadline or the next timer expiration
+    static void wait_message(f64 deadline)
+    {
+        deadline = std::min(deadline, platform::next_timer_deadline());
+        if (std::isinf(deadline))
+        {
+            WaitMessage();
+            return;
+        }
+        const f64 timeout = deadline - get_time();
+        if (timeout > 0.0) MsgWaitForMultipleObjects(0, NULL, FALSE, (DWORD)std::ceil(timeout * 1e3), QS_ALLINPUT);
+    }
+
     void wait_events()
     {
-        WaitMessage();
+        wait_message(INFINITY);
         poll_events();
     }
 
@@ -813,9 +833,14 @@ namespace awin
 
         while (PeekMessageW(&msg, NULL, 0, 0, PM_REMOVE))
         {
+            platform::EventTimeScope time_scope((u32)msg.time);
             TranslateMessage(&msg);
             DispatchMessageW(&msg);
         }
+        platform::flush_deferred_events();
+        platform::deliver_batched_events();
+        platform::publish_input_snapshots();
+        fire_timers();
 
         auto *window = (platform::Win32WindowData *)GetPropW(hwnd, L"AWIN");
         if (!window) return;
@@ -823,18 +848,23 @@ namespace awin
 
     void wait_events_timeout()
     {
-        if (platform::g_env->timeout > WINDOW_TIMEOUT_INF)
-        {
-            MsgWaitForMultipleObjects(0, NULL, FALSE, platform::g_env->timeout * 1e3, QS_ALLINPUT);
-            platform::g_env->timeout = WINDOW_TIMEOUT_INF;
-        }
-        else
-            WaitMessage();
+        const f64 timeout = platform::g_env->timeout;
+        wait_message(timeout > WINDOW_TIMEOUT_INF ? get_time() + timeout : INFINITY);
+        poll_events();
+    }
+
+    void wait_events_until(f64 deadline)
+    {
+        wait_message(deadline);
         poll_events();
     }
 
     void push_empty_event() { PostThreadMessageW(platform::ctx.thread_id, WM_NULL, 0, 0); }
 
+    void begin_batch() {}
+
+    void end_batch() {}
+
     f32 get_dpi(const Window &) { return static_cast<f32>(platform::ctx.dpi) / 96.0f; }
 
     acul::point2D<i32> get_window_size(const Window &window)
@@ -972,6 +1002,123 @@ namespace awin
 
     void Cursor::assign(Window *window) { SetCursor(_pd->cursor); }
 
+    // Software surfaces draw into top-down 32-bit DIB sections, the damaged rectangles are copied to the window with
+    // BitBlt. GDI has read the pixels once BitBlt returns, so no buffer is ever held by the system.
+    struct SoftwareSurface::Platform
+    {
+        struct Buffer
+        {
+            HBITMAP bitmap;
+            u32 *pixels;
+            u64 presented; // Frame the buffer was presented as, 0 if never
+        };
+
+        platform::Win32WindowData *window;
+        HDC memory_dc;
+        acul::point2D<i32> size{0, 0};
+        acul::vector<Buffer> buffers;
+        u64 presents = 0;
+        int acquired = -1;
+
+        void release_buffers()
+        {
+            for (auto &buffer : buffers)
+            {
+                if (buffer.bitmap) DeleteObject(buffer.bitmap);
+                buffer = {};
+            }
+        }
+    };
+
+    SoftwareSurface::SoftwareSurface(Window &window, u32 buffer_count) : _pd(nullptr)
+    {
+        HDC memory_dc = CreateCompatibleDC(NULL);
+        if (!memory_dc)
+        {
+            AWIN_LOG_ERROR("Failed to create a memory device context for the software surface");
+            return;
+        }
+        _pd = acul::alloc<Platform>();
+        _pd->window = (platform::Win32WindowData *)get_window_data(window);
+        _pd->memory_dc = memory_dc;
+        _pd->buffers.resize(std::clamp(buffer_count, 1U, 3U));
+        for (auto &buffer : _pd->buffers) buffer = {};
+    }
+
+    SoftwareSurface::~SoftwareSurface()
+    {
+        if (!_pd) return;
+        _pd->release_buffers();
+        DeleteDC(_pd->memory_dc);
+        acul::release(_pd);
+    }
+
+    bool SoftwareSurface::acquire(Buffer &out)
+    {
+        if (!_pd) return false;
+        const acul::point2D<i32> size = _pd->window->dimenstions;
+        if (size.x <= 0 || size.y <= 0) return false;
+        if (!(_pd->size == size))
+        {
+            _pd->release_buffers();
+            _pd->size = size;
+        }
+
+        int index = 0;
+        for (int i = 1; i < (int)_pd->buffers.size(); ++i)
+            if (_pd->buffers[i].presented < _pd->buffers[index].presented) index = i;
+
+        auto &buffer = _pd->buffers[index];
+        if (!buffer.bitmap)
+        {
+            BITMAPINFO bmi = {};
+            bmi.bmiHeader.biSize = sizeof(bmi.bmiHeader);
+            bmi.bmiHeader.biWidth = size.x;
+            bmi.bmiHeader.biHeight = -size.y; // Top-down rows
+            bmi.bmiHeader.biPlanes = 1;
+            bmi.bmiHeader.biBitCount = 32;
+            bmi.bmiHeader.biCompression = BI_RGB;
+            void *bits = nullptr;
+            buffer.bitmap = CreateDIBSection(_pd->memory_dc, &bmi, DIB_RGB_COLORS, &bits, NULL, 0);
+            if (!buffer.bitmap)
+            {
+                AWIN_LOG_ERROR("Failed to create a DIB section of %dx%d for the software surface", size.x, size.y);
+                return false;
+            }
+            buffer.pixels = (u32 *)bits;
+        }
+
+        _pd->acquired = index;
+        out.pixels = buffer.pixels;
+        out.stride = size.x;
+        out.size = size;
+        out.age = buffer.presented ? (u32)(_pd->presents - buffer.presented + 1) : 0;
+        return true;
+    }
+
+    void SoftwareSurface::present(std::span<const DamageRect> damage)
+    {
+        if (!_pd || _pd->acquired < 0) return;
+        auto &buffer = _pd->buffers[_pd->acquired];
+        _pd->acquired = -1;
+
+        HDC dc = GetDC(_pd->window->hwnd);
+        HGDIOBJ previous = SelectObject(_pd->memory_dc, buffer.bitmap);
+        const DamageRect full{0, 0, _pd->size.x, _pd->size.y};
+        if (damage.empty()) damage = {&full, 1};
+        for (const auto &rect : damage)
+        {
+            const i32 x = std::max(rect.x, 0), y = std::max(rect.y, 0);
+            const i32 right = std::min(rect.x + rect.width, _pd->size.x);
+            const i32 bottom = std::min(rect.y + rect.height, _pd->size.y);
+            if (right > x && bottom > y) BitBlt(dc, x, y, right - x, bottom - y, _pd->memory_dc, x, y, SRCCOPY);
+        }
+        SelectObject(_pd->memory_dc, previous);
+        ReleaseDC(_pd->window->hwnd, dc);
+
+        buffer.presented = ++_pd->presents;
+    }
+
     HWND native_access::get_hwnd(const Window &window)
     {
         auto *wd = (platform::Win32WindowData *)get_window_data(window);
@@ -1,5 +1,14 @@
 #pragma once
 #include <acul/string/string.hpp>
+#include <acul/vector.hpp>
+#include <tuple>
+#include <type_traits>
+#include <variant>
+#ifndef _WIN32
+    #include <poll.h>
+    #include "wake_event.hpp"
+#endif
+#include <awin/trace.hpp>
 #include <awin/window.hpp>
 #include "awin/types.hpp"
 
@@ -26,8 +35,58 @@ namespace awin
             acul::events::event_group *maximize;
             acul::events::event_group *resize;
             acul::events::event_group *move;
+            acul::events::event_group *live_resize;
             acul::events::event_group *dpi_changed;
+            acul::events::event_group *batch;
+        };
+
+        // Events of one type queued for batched delivery
+        template <typename T>
+        struct EventBatchQueue
+        {
+            acul::events::event_group *group = nullptr; // Listeners of the individual events.
+            acul::vector<T> events;                     // Events queued during the current cycle.
+            acul::vector<T> delivering;                 // Events being delivered, kept to reuse the storage.
+        };
+
+        using EventBatches = std::tuple<EventBatchQueue<KeyInputEvent>, EventBatchQueue<CharInputEvent>,
+                                        EventBatchQueue<MouseClickEvent>, EventBatchQueue<MouseEnterEvent>,
+                                        EventBatchQueue<PosEvent>, EventBatchQueue<DeltaEvent>,
+                                        EventBatchQueue<ScrollEvent>>;
+
+        template <typename T, typename Batches>
+        struct is_batched;
+
+        template <typename T, typename... Queues>
+        struct is_batched<T, std::tuple<Queues...>>
+            : std::bool_constant<(std::is_same_v<EventBatchQueue<T>, Queues> || ...)>
+        {
+        };
+
+        // The state of a window published by the event thread, applied to WindowData::state on delivery
+        struct WindowStateUpdate
+        {
+            Window *window;
+            WindowState state;
+        };
+
+        // Events produced on the event thread and handed over to the thread polling events
+        using ThreadEvent =
+            std::variant<std::monostate, FocusEvent, CharInputEvent, KeyInputEvent, MouseClickEvent, MouseEnterEvent,
+                         StateEvent, PosEvent, DeltaEvent, ScrollEvent, DpiChangedEvent, WindowStateUpdate>;
+
+        struct EventThread;
+
+#ifndef _WIN32
+        // A descriptor of the application watched by the event loop
+        struct FdWatch
+        {
+            int fd;
+            i16 events;
+            FdWatchCallback callback;
+            void *user_data;
         };
+#endif
 
         extern APPLIB_API struct WindowEnvironment
         {
@@ -39,17 +98,134 @@ namespace awin
 #endif
                 u64 offset;                   // Time offset
                 u64 frequency;                // Timer frequency
+                f64 seconds_per_tick;         // Precomputed 1 / frequency.
+                u64 ns_per_tick;              // Nanoseconds per tick, zero if the frequency does not divide 1e9.
             } timer;                          // Timer information for time tracking.
             f64 timeout = WINDOW_TIMEOUT_INF; // Global timeout for waking up the main loop.
+            int backend = WINDOW_BACKEND_UNKNOWN; // Requested window backend.
             acul::events::dispatcher *ed = nullptr;
             acul::log::log_service *log_service = nullptr;
             acul::log::logger_base *logger = nullptr;
             Cursor default_cursor;
             EventRegistry events;
+            CoalesceFlags coalescing = CoalesceBits::none; // Events merged per poll cycle.
+            acul::vector<WindowData *> deferred;           // Windows with events held back until the cycle ends.
+            acul::vector<WindowData *> input_windows;      // Windows whose input snapshot changes this cycle.
+            trace::Recorder *recorder = nullptr;           // Active event recorder, if any.
+            bool batching = false;                         // Input events are queued and delivered per type.
+            EventBatches batches;                          // Input events queued for batched delivery.
+            u32 server_time = 0;                           // Server timestamp of the native event being processed.
+            EventThread *event_thread = nullptr;           // Thread owning the display connection, if enabled.
+            acul::vector<awin::Timer *> timers;            // Active timers.
+            u64 timer_cycle = 0;                           // Poll cycles that fired timers.
+#ifndef _WIN32
+            acul::vector<FdWatch> fd_watches;   // Descriptors of the application watched by the event loop.
+            acul::vector<pollfd> poll_set;      // Scratch set for polling the backend and the watched descriptors.
+            acul::vector<pollfd> ready_watches; // Watched descriptors found ready by the waits of the cycle.
+            bool watches_polled = false;        // The waits of the cycle polled the watched descriptors.
+            int event_fd = -1;                  // Descriptor returned by get_event_fd, created on first use.
+            WakeEvent wake;                     // Wakes the thread waiting in the backend event loop.
+            int timer_fd = -1;                  // Armed at the earliest deadline of the active timers.
+            bool xcb_events = false;            // X11 events are read through XCB, see InitConfig.
+#endif
         } *g_env;
+
+        // Publishes the server timestamp of the native event being processed for the events it dispatches
+        struct EventTimeScope
+        {
+            u32 previous;
+
+            explicit EventTimeScope(u32 time) : previous(g_env->server_time) { g_env->server_time = time; }
+            ~EventTimeScope() { g_env->server_time = previous; }
+        };
+
+        // Updates the input state collected for the snapshot of the window the event belongs to
+        void track_input(const acul::events::event &event);
+
+        // Get the state of the window read through the accessors of Window
+        inline WindowState capture_window_state(const WindowData *data)
+        {
+            WindowState state;
+            state.dimensions = data->dimenstions;
+            state.flags = data->flags;
+            state.is_cursor_hidden = data->is_cursor_hidden;
+            state.focused = data->focused;
+            state.ready_to_close = data->ready_to_close;
+            state.resize_limit = data->resize_limit;
+            return state;
+        }
+
+        inline bool same_window_state(const WindowState &a, const WindowState &b)
+        {
+            return a.dimensions == b.dimensions && a.flags == b.flags && a.is_cursor_hidden == b.is_cursor_hidden &&
+                   a.focused == b.focused && a.ready_to_close == b.ready_to_close && a.resize_limit == b.resize_limit;
+        }
+
+#ifndef _WIN32
+        // Check if the calling thread is the event thread
+        bool is_event_thread();
+
+        // Hands an event produced on the event thread over to the polling thread
+        void queue_thread_event(ThreadEvent &&event);
+#endif
+
+        // Delivers a constructed event to the listeners of the group
+        template <typename T>
+        inline void deliver_event(acul::events::event_group *group, T &event)
+        {
+            if constexpr (std::is_base_of_v<InputEvent, T>)
+            {
+                event.dispatch_time = get_time();
+                track_input(event);
+            }
+            if (g_env->recorder) g_env->recorder->record(event);
+            if constexpr (is_batched<T, EventBatches>::value)
+            {
+                // Window motion shares the event type with the cursor motion but is not batched
+                if (g_env->batching && (!std::is_same_v<T, PosEvent> || event.id == event_id::mouse_move))
+                {
+                    if (!group && !g_env->events.batch) return;
+                    auto &queue = std::get<EventBatchQueue<T>>(g_env->batches);
+                    queue.group = group;
+                    queue.events.push_back(event);
+                    return;
+                }
+            }
+            if (!group) return;
+            for (const auto &node : *group) node.call(node.ctx, event);
+        }
+
+        // Constructs the event and delivers it to the listeners of the group. On the event thread the event is
+        // queued instead and delivered by the next poll of the polling thread.
+        template <typename T, typename... Args>
+        inline void dispatch_event(acul::events::event_group *group, Args &&...args)
+        {
+            T event(std::forward<Args>(args)...);
+            if constexpr (std::is_base_of_v<InputEvent, T>) event.server_time = g_env->server_time;
+#ifndef _WIN32
+            if (g_env->event_thread && is_event_thread())
+            {
+                queue_thread_event(ThreadEvent(std::move(event)));
+                return;
+            }
+#endif
+            deliver_event(group, event);
+        }
+
+        // Get the cached listener group of the event identifier
+        acul::events::event_group *get_event_group(u64 id);
+
+        // Get the earliest deadline of the active timers, or infinity without active timers
+        f64 next_timer_deadline();
+
+        // Rearm the platform wakeup after the active timers changed
+        void update_timers();
     } // namespace platform
 
     inline WindowData *get_window_data(const Window &window) { return window._data; }
+
+    // Fires the expired timers. Called at the end of every poll cycle, after its events have been delivered.
+    void fire_timers();
 } // namespace awin
 
 #define AWIN_LOG_DEFAULT(level, ...) \
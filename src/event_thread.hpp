@@ -0,0 +1,117 @@
+#pragma once
+#include <atomic>
+#include <thread>
+#include "env.hpp"
+#include "spsc_queue.hpp"
+
+// Optional dedicated event thread (Linux). The thread owns the display connection: it runs the backend event loop,
+// answers the window manager and queues the produced events for the thread that polls them. Calls of the public API
+// made while it is running are marshalled to it through the command queue, which only the polling thread may fill.
+// The window state read by the polling thread is a copy the event thread publishes through the event queue.
+namespace awin
+{
+    namespace platform
+    {
+        // A call to run on the event thread
+        struct Command
+        {
+            void (*invoke)(void *ctx);
+            void *ctx;
+        };
+
+        // The window state last published to the polling thread
+        struct PublishedWindowState
+        {
+            WindowData *data;
+            WindowState state;
+        };
+
+        struct EventThread
+        {
+            std::thread thread;
+            std::thread::id polling_thread; // The only thread submitting commands.
+            std::atomic<bool> running{true};
+            SpscQueue<Command, 256> commands;    // Polling thread -> event thread.
+            SpscQueue<ThreadEvent, 8192> events; // Event thread -> polling thread.
+            acul::vector<ThreadEvent> overflow;  // Events waiting for room in the queue, event thread only.
+            acul::vector<ThreadEvent> pending;   // Events taken out of the queue for delivery, polling thread only.
+            WakeEvent wake;                      // Readable while queued events wait for the polling thread.
+            std::atomic<bool> overflowed{false};
+            acul::vector<PublishedWindowState> windows; // Event thread only.
+        };
+
+        // Start the event thread. The platform must already be initialized.
+        bool start_event_thread();
+
+        // Stop the event thread and wait for it to exit. Undelivered events are dropped.
+        void stop_event_thread();
+
+        // Queue a command and wake the event thread
+        void submit_command(Command command);
+
+        // Wake the polling thread from wait_thread_events. Can be called from any thread.
+        void wake_polling_thread();
+
+        // Deliver the events queued by the event thread to the listeners
+        void deliver_thread_events();
+
+        // Wait until the event thread queues events or the timeout expires
+        void wait_thread_events(f64 *timeout);
+
+        // Drop the undelivered events of the window
+        void drop_thread_events(Window *window);
+
+        // Drop the events of the window still waiting in the overflow list. Event thread only.
+        void drop_overflow_events(Window *window);
+
+        // Start publishing the state of a created window to the polling thread. Event thread only.
+        void track_window_state(WindowData *data);
+
+        // Stop publishing the state of a destroyed window. Event thread only.
+        void untrack_window_state(WindowData *data);
+
+        // Run the call on the event thread and wait for its result. Runs it directly without an event thread.
+        template <typename F>
+        auto run_command(F &&fn) -> decltype(fn())
+        {
+            using R = decltype(fn());
+            if (!g_env->event_thread || is_event_thread()) return fn();
+
+            struct Call
+            {
+                std::remove_reference_t<F> *fn;
+                std::conditional_t<std::is_void_v<R>, bool, R> result{};
+                std::atomic<bool> done{false};
+            } call{&fn};
+            submit_command({[](void *ctx) {
+                                auto *call = static_cast<Call *>(ctx);
+                                if constexpr (std::is_void_v<R>)
+                                    (*call->fn)();
+                                else
+                                    call->result = (*call->fn)();
+                                call->done.store(true, std::memory_order_release);
+                                call->done.notify_one();
+                            },
+                            &call});
+            call.done.wait(false, std::memory_order_acquire);
+            if constexpr (!std::is_void_v<R>) return std::move(call.result);
+        }
+
+        // Queue the call for the event thread without waiting for it. Runs it directly without an event thread.
+        template <typename F>
+        void post_command(F fn)
+        {
+            if (!g_env->event_thread || is_event_thread())
+            {
+                fn();
+                return;
+            }
+            submit_command({[](void *ctx) {
+                                auto *call = static_cast<F *>(ctx);
+                                (*call)();
+                                acul::release(call);
+                            },
+                            acul::alloc<F>(std::move(fn))});
+        }
+    } // namespace platform
+} // namespace awin
@@ -0,0 +1,84 @@
+#include "platform.hpp"
+
+namespace awin::platform::headless
+{
+    Context *g_ctx = nullptr;
+
+    bool init_platform()
+    {
+        if (!g_ctx)
+        {
+            g_ctx = acul::alloc<Context>();
+            g_ctx->monitor = {{1920, 1080}, {1920, 1080}};
+            g_ctx->dpi = 1.0f;
+        }
+
+        AWIN_LOG_INFO("Created headless window context");
+        return true;
+    }
+
+    void destroy_platform()
+    {
+        if (!g_ctx) return;
+        acul::release(g_ctx);
+        g_ctx = nullptr;
+    }
+
+    WindowData *alloc_window_data() { return acul::alloc<HeadlessWindowData>(); }
+
+    void init_pcall_data(LinuxPlatformCaller &caller)
+    {
+        caller.init_platform = init_platform;
+        caller.destroy_platform = destroy_platform;
+        caller.alloc_window_data = alloc_window_data;
+        caller.poll_events = poll_events;
+        caller.wait_events = wait_events;
+        caller.wait_events_timeout = wait_events_timeout;
+        caller.get_event_fds = get_event_fds;
+        caller.get_dpi = get_dpi;
+        caller.get_window_size = get_window_size;
+        caller.get_clipboard_string = get_clipboard_string;
+        caller.set_clipboard_string = set_clipboard_string;
+        caller.get_primary_monitor_info = get_primary_monitor_info;
+    }
+
+    void init_wcall_data(LinuxWindowCaller &caller)
+    {
+        caller.destroy = destroy;
+        caller.create_window = create_window;
+        caller.set_window_icon = set_window_icon;
+        caller.show_window = show_window;
+        caller.hide_window = hide_window;
+        caller.get_window_title = get_window_title;
+        caller.set_window_title = set_window_title;
+        caller.enable_fullscreen = enable_fullscreen;
+        caller.disable_fullscreen = disable_fullscreen;
+        caller.get_cursor_position = get_cursor_position;
+        caller.query_cursor_position = get_cursor_position;
+        caller.set_cursor_position = set_cursor_position;
+        caller.hide_cursor = hide_cursor;
+        caller.show_cursor = show_cursor;
+        caller.get_window_position = get_window_position;
+        caller.set_window_position = set_window_position;
+        caller.center_window = center_window;
+        caller.update_resize_limit = update_resize_limit;
+        caller.minimize_window = minimize_window;
+        caller.maximize_window = maximize_window;
+    }
+
+    void init_ccall_data(LinuxCursorCaller &caller)
+    {
+        caller.create = create_cursor;
+        caller.assign = assign_cursor;
+        caller.destroy = destroy_cursor;
+        caller.valid = is_cursor_valid;
+    }
+
+    void init_scall_data(LinuxSoftwareCaller &caller)
+    {
+        caller.create = create_software_surface;
+        caller.acquire = acquire_software_buffer;
+        caller.present = present_software_buffer;
+        caller.destroy = destroy_software_surface;
+    }
+} // namespace awin::platform::headless
@@ -0,0 +1,415 @@
+#include <algorithm>
+#include <awin/headless.hpp>
+#include "../event_thread.hpp"
+#include "platform.hpp"
+
+namespace awin
+{
+    namespace platform::headless
+    {
+        static void process_event(const InjectedEvent &event)
+        {
+            auto *window_data = event.window;
+            switch (event.type)
+            {
+                case InjectedEvent::Type::key:
+                    input_key(window_data, event.key, event.action, event.mods);
+                    return;
+                case InjectedEvent::Type::char_input:
+                    dispatch_event<CharInputEvent>(g_env->events.char_input, window_data->owner, event.char_code);
+                    return;
+                case InjectedEvent::Type::mouse_click:
+                    input_mouse_click(window_data, event.button, event.action, event.mods);
+                    return;
+                case InjectedEvent::Type::mouse_enter:
+                    if (window_data->hovered == event.state) return;
+                    window_data->hovered = event.state;
+                    input_mouse_enter(window_data, event.state);
+                    return;
+                case InjectedEvent::Type::cursor_pos:
+                    window_data->cursor_pos = event.pos;
+                    input_cursor_pos(window_data, event.pos);
+                    return;
+                case InjectedEvent::Type::cursor_delta:
+                    input_cursor_delta(window_data, event.delta);
+                    return;
+                case InjectedEvent::Type::scroll:
+                    input_scroll(window_data, event.delta.x, event.delta.y);
+                    return;
+                case InjectedEvent::Type::focus:
+                    if (window_data->focused == event.state) return;
+                    window_data->focused = event.state;
+                    input_focus(window_data, event.state);
+                    return;
+                case InjectedEvent::Type::resize:
+                    if (window_data->dimenstions == event.pos) return;
+                    window_data->dimenstions = event.pos;
+                    input_window_resize(window_data, event.pos);
+                    return;
+                case InjectedEvent::Type::live_resize:
+                    input_live_resize(window_data, event.state);
+                    return;
+                case InjectedEvent::Type::move:
+                    if (window_data->position == event.pos) return;
+                    window_data->position = event.pos;
+                    dispatch_event<PosEvent>(g_env->events.move, event_id::move, window_data->owner, event.pos);
+                    return;
+                case InjectedEvent::Type::close:
+                    window_data->ready_to_close = true;
+                    return;
+                default:
+                    return;
+            }
+        }
+
+        static void wait_for_any_event(f64 *timeout)
+        {
+            if (!g_ctx->queue.empty()) return;
+            struct pollfd fds[] = {{g_env->wake.fd, POLLIN}};
+            bool watched;
+            poll_watched(fds, sizeof(fds) / sizeof(fds[0]), timeout, watched);
+        }
+
+        void poll_events()
+        {
+            drain_wake_event(g_env->wake);
+
+            // Events injected by listeners are left for the next cycle, as a native queue would do
+            const size_t count = g_ctx->queue.size();
+            for (size_t i = 0; i < count; ++i)
+            {
+                const InjectedEvent event = g_ctx->queue[i];
+                process_event(event);
+            }
+
+            if (count == g_ctx->queue.size())
+                g_ctx->queue.clear();
+            else
+                g_ctx->queue.erase(g_ctx->queue.begin(), g_ctx->queue.begin() + count);
+        }
+
+        void wait_events()
+        {
+            wait_for_any_event(NULL);
+            poll_events();
+        }
+
+        void wait_events_timeout(f64 timeout)
+        {
+            wait_for_any_event(&timeout);
+            poll_events();
+        }
+
+        void get_event_fds(acul::vector<int> &fds) { fds.push_back(g_env->wake.fd); }
+
+        f32 get_dpi(WindowData *) { return g_ctx->dpi; }
+
+        acul::point2D<i32> get_window_size(const Window &window) { return get_window_data(window)->dimenstions; }
+
+        acul::string get_clipboard_string() { return g_ctx->clipboard; }
+
+        void set_clipboard_string(const acul::string &text) { g_ctx->clipboard = text; }
+
+        MonitorInfo get_primary_monitor_info() { return g_ctx->monitor; }
+
+        bool create_window(WindowData *window_data, const acul::string &title, i32 width, i32 height,
+                           WindowFlags flags)
+        {
+            auto *headless_data = (HeadlessWindowData *)window_data;
+            headless_data->title = title;
+            headless_data->dimenstions = {width == WINDOW_DONT_CARE ? 800 : width,
+                                          height == WINDOW_DONT_CARE ? 600 : height};
+            headless_data->flags = flags;
+            headless_data->cursor = &g_env->default_cursor;
+            AWIN_LOG_INFO("Headless: Created window: %p", headless_data);
+            return true;
+        }
+
+        void destroy(WindowData *window_data)
+        {
+            auto &queue = g_ctx->queue;
+            auto it = std::remove_if(queue.begin(), queue.end(),
+                                     [window_data](const InjectedEvent &event) { return event.window == window_data; });
+            queue.erase(it, queue.end());
+            AWIN_LOG_INFO("Headless: Destroying window: %p", window_data);
+        }
+
+        void set_window_icon(WindowData *, const acul::vector<Image> &) {}
+
+        void show_window(WindowData *) {}
+
+        void hide_window(WindowData *) {}
+
+        acul::string get_window_title(WindowData *window_data) { return ((HeadlessWindowData *)window_data)->title; }
+
+        void set_window_title(WindowData *window_data, const acul::string &title)
+        {
+            ((HeadlessWindowData *)window_data)->title = title;
+        }
+
+        void enable_fullscreen(WindowData *) {}
+
+        void disable_fullscreen(WindowData *) {}
+
+        acul::point2D<i32> get_cursor_position(WindowData *window_data)
+        {
+            return ((HeadlessWindowData *)window_data)->cursor_pos;
+        }
+
+        void set_cursor_position(WindowData *window_data, acul::point2D<i32> position)
+        {
+            ((HeadlessWindowData *)window_data)->cursor_pos = position;
+        }
+
+        void hide_cursor(WindowData *window_data) { window_data->is_cursor_hidden = true; }
+
+        void show_cursor(Window *, WindowData *window_data) { window_data->is_cursor_hidden = false; }
+
+        acul::point2D<i32> get_window_position(WindowData *window)
+        {
+            return ((HeadlessWindowData *)window)->position;
+        }
+
+        void set_window_position(WindowData *window, acul::point2D<i32> position)
+        {
+            ((HeadlessWindowData *)window)->position = position;
+        }
+
+        void center_window(WindowData *window)
+        {
+            const auto &work = g_ctx->monitor.work;
+            ((HeadlessWindowData *)window)->position = {static_cast<i32>(work.x - window->dimenstions.x) / 2,
+                                                        static_cast<i32>(work.y - window->dimenstions.y) / 2};
+        }
+
+        void update_resize_limit(WindowData *) {}
+
+        void minimize_window(WindowData *window)
+        {
+            if (window->flags & WindowFlagBits::minimized) return;
+            window->flags |= WindowFlagBits::minimized;
+            dispatch_event<StateEvent>(g_env->events.minimize, event_id::minimize, window->owner, true);
+        }
+
+        void maximize_window(WindowData *window)
+        {
+            const bool maximized = !(window->flags & WindowFlagBits::maximized);
+            if (maximized)
+                window->flags |= WindowFlagBits::maximized;
+            else
+                window->flags &= ~WindowFlagBits::maximized;
+            dispatch_event<StateEvent>(g_env->events.maximize, event_id::maximize, window->owner, maximized);
+        }
+
+        Cursor::Platform *create_cursor(Cursor::Type type)
+        {
+            auto *cursor = acul::alloc<HeadlessCursor>();
+            cursor->type = type;
+            return cursor;
+        }
+
+        void assign_cursor(Window *, Cursor::Platform *) {}
+
+        void destroy_cursor(Cursor::Platform *) {}
+
+        bool is_cursor_valid(const Cursor::Platform *cursor) { return cursor != nullptr; }
+
+        SoftwareSurface::Platform *create_software_surface(WindowData *window_data, u32 buffer_count)
+        {
+            auto *surface = acul::alloc<HeadlessSoftwareSurface>();
+            surface->window = window_data;
+            surface->buffers.resize(buffer_count);
+            for (auto &buffer : surface->buffers) buffer.presented = 0;
+            return surface;
+        }
+
+        bool acquire_software_buffer(SoftwareSurface::Platform *pd, SoftwareSurface::Buffer &out)
+        {
+            auto *surface = (HeadlessSoftwareSurface *)pd;
+            const acul::point2D<i32> size = surface->window->dimenstions;
+            if (size.x <= 0 || size.y <= 0) return false;
+            if (!(surface->size == size))
+            {
+                surface->size = size;
+                for (auto &buffer : surface->buffers)
+                {
+                    buffer.pixels.assign((size_t)size.x * size.y, 0);
+                    buffer.presented = 0;
+                }
+            }
+
+            // Nothing reads the buffers after the present, the one shown longest ago is reused
+            int index = 0;
+            for (int i = 1; i < (int)surface->buffers.size(); ++i)
+                if (surface->buffers[i].presented < surface->buffers[index].presented) index = i;
+
+            auto &buffer = surface->buffers[index];
+            surface->acquired = index;
+            out.pixels = buffer.pixels.data();
+            out.stride = size.x;
+            out.size = size;
+            out.age = surface->buffer_age(buffer.presented);
+            return true;
+        }
+
+        void present_software_buffer(SoftwareSurface::Platform *pd, std::span<const DamageRect> damage)
+        {
+            auto *surface = (HeadlessSoftwareSurface *)pd;
+            auto &buffer = surface->buffers[surface->acquired];
+            surface->acquired = -1;
+
+            // Like a display server, only the damaged pixels reach the window, the rest keeps the previous frame
+            auto *window = (HeadlessWindowData *)surface->window;
+            const acul::point2D<i32> size = surface->size;
+            if (!(window->frame_size == size))
+            {
+                window->frame.assign((size_t)size.x * size.y, 0);
+                window->frame_size = size;
+            }
+            const DamageRect full{0, 0, size.x, size.y};
+            if (damage.empty()) damage = {&full, 1};
+            for (const auto &rect : damage)
+            {
+                const i32 x = std::max(rect.x, 0), y = std::max(rect.y, 0);
+                const i32 right = std::min(rect.x + rect.width, size.x);
+                const i32 bottom = std::min(rect.y + rect.height, size.y);
+                if (right <= x || bottom <= y) continue;
+                for (i32 row = y; row < bottom; ++row)
+                    std::copy(buffer.pixels.begin() + row * size.x + x, buffer.pixels.begin() + row * size.x + right,
+                              window->frame.begin() + row * size.x + x);
+            }
+
+            buffer.presented = ++surface->presents;
+        }
+
+        void destroy_software_surface(SoftwareSurface::Platform *pd) { acul::release((HeadlessSoftwareSurface *)pd); }
+    } // namespace platform::headless
+
+    namespace headless
+    {
+        using platform::headless::InjectedEvent;
+
+        static InjectedEvent make_event(Window &window, InjectedEvent::Type type)
+        {
+            InjectedEvent event{};
+            event.type = type;
+            event.window = (platform::headless::HeadlessWindowData *)get_window_data(window);
+            return event;
+        }
+
+        // The queue belongs to the thread running the backend, which is the event thread when there is one
+        static void push_event(const InjectedEvent &event)
+        {
+            using namespace platform::headless;
+            if (!g_ctx)
+            {
+                AWIN_LOG_ERROR("Headless: Input injection requires the headless backend");
+                return;
+            }
+            // The wake event keeps the event descriptor readable while injected events are queued
+            platform::post_command([event] {
+                g_ctx->queue.push_back(event);
+                platform::signal_wake_event(platform::g_env->wake);
+            });
+        }
+
+        void inject_key(Window &window, io::Key key, io::KeyPressState action, io::KeyMode mods)
+        {
+            auto event = make_event(window, InjectedEvent::Type::key);
+            event.key = key;
+            event.action = action;
+            event.mods = mods;
+            push_event(event);
+        }
+
+        void inject_char(Window &window, u32 char_code)
+        {
+            auto event = make_event(window, InjectedEvent::Type::char_input);
+            event.char_code = char_code;
+            push_event(event);
+        }
+
+        void inject_mouse_click(Window &window, io::MouseKey button, io::KeyPressState action, io::KeyMode mods)
+        {
+            auto event = make_event(window, InjectedEvent::Type::mouse_click);
+            event.button = button;
+            event.action = action;
+            event.mods = mods;
+            push_event(event);
+        }
+
+        void inject_mouse_enter(Window &window, bool entered)
+        {
+            auto event = make_event(window, InjectedEvent::Type::mouse_enter);
+            event.state = entered;
+            push_event(event);
+        }
+
+        void inject_cursor_pos(Window &window, acul::point2D<i32> position)
+        {
+            auto event = make_event(window, InjectedEvent::Type::cursor_pos);
+            event.pos = position;
+            push_event(event);
+        }
+
+        void inject_cursor_delta(Window &window, acul::point2D<f64> delta)
+        {
+            auto event = make_event(window, InjectedEvent::Type::cursor_delta);
+            event.delta = delta;
+            push_event(event);
+        }
+
+        void inject_scroll(Window &window, f32 h, f32 v)
+        {
+            auto event = make_event(window, InjectedEvent::Type::scroll);
+            event.delta = {h, v};
+            push_event(event);
+        }
+
+        void inject_focus(Window &window, bool focused)
+        {
+            auto event = make_event(window, InjectedEvent::Type::focus);
+            event.state = focused;
+            push_event(event);
+        }
+
+        void inject_resize(Window &window, acul::point2D<i32> size)
+        {
+            auto event = make_event(window, InjectedEvent::Type::resize);
+            event.pos = size;
+            push_event(event);
+        }
+
+        void inject_live_resize(Window &window, bool active)
+        {
+            auto event = make_event(window, InjectedEvent::Type::live_resize);
+            event.state = active;
+            push_event(event);
+        }
+
+        void inject_move(Window &window, acul::point2D<i32> position)
+        {
+            auto event = make_event(window, InjectedEvent::Type::move);
+            event.pos = position;
+            push_event(event);
+        }
+
+        void inject_close(Window &window) { push_event(make_event(window, InjectedEvent::Type::close)); }
+
+        size_t pending_events()
+        {
+            using namespace platform::headless;
+            if (!g_ctx) return 0;
+            return platform::run_command([] { return g_ctx->queue.size(); });
+        }
+
+        std::span<const u32> get_presented_frame(const Window &window, acul::point2D<i32> *size)
+        {
+            auto *window_data = (platform::headless::HeadlessWindowData *)get_window_data(window);
+            return platform::run_command([window_data, size] {
+                if (size) *size = window_data->frame_size;
+                return std::span<const u32>(window_data->frame.data(), window_data->frame.size());
+            });
+        }
+    } // namespace headless
+} // namespace awin
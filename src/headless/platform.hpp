@@ -0,0 +1,119 @@
+#pragma once
+
+#include <acul/string/string.hpp>
+#include <acul/vector.hpp>
+#include "../env.hpp"
+#include "../linux_pd.hpp"
+
+namespace awin::platform::headless
+{
+    struct HeadlessWindowData final : WindowData
+    {
+        acul::string title;
+        acul::point2D<i32> position{0, 0};
+        acul::point2D<i32> cursor_pos{0, 0};
+        bool hovered{false};
+        acul::vector<u32> frame; // Pixels of the last software surface present, see headless::get_presented_frame
+        acul::point2D<i32> frame_size{0, 0};
+    };
+
+    // A synthetic event waiting for the next poll cycle
+    struct InjectedEvent
+    {
+        enum class Type : u8
+        {
+            key,
+            char_input,
+            mouse_click,
+            mouse_enter,
+            cursor_pos,
+            cursor_delta,
+            scroll,
+            focus,
+            resize,
+            live_resize,
+            move,
+            close
+        } type;
+        HeadlessWindowData *window;
+        io::Key key;
+        io::MouseKey button;
+        io::KeyPressState action;
+        io::KeyMode mods;
+        u32 char_code;
+        bool state;
+        acul::point2D<i32> pos;
+        acul::point2D<f64> delta; // Also carries the scroll offsets
+    };
+
+    extern APPLIB_API struct Context
+    {
+        acul::vector<InjectedEvent> queue;
+        acul::string clipboard;
+        MonitorInfo monitor;
+        f32 dpi;
+    } *g_ctx;
+
+    struct HeadlessCursor final : Cursor::Platform
+    {
+        Cursor::Type type;
+    };
+
+    struct HeadlessSoftwareBuffer
+    {
+        acul::vector<u32> pixels;
+        u64 presented; // Frame the buffer was presented as, 0 if never
+    };
+
+    struct HeadlessSoftwareSurface final : SoftwareSurface::Platform
+    {
+        acul::point2D<i32> size{0, 0};
+        acul::vector<HeadlessSoftwareBuffer> buffers;
+    };
+
+    void init_pcall_data(LinuxPlatformCaller &caller);
+    void init_wcall_data(LinuxWindowCaller &caller);
+    void init_ccall_data(LinuxCursorCaller &caller);
+    void init_scall_data(LinuxSoftwareCaller &caller);
+
+    void poll_events();
+    void wait_events();
+    void wait_events_timeout(f64 timeout);
+    void get_event_fds(acul::vector<int> &fds);
+    f32 get_dpi(WindowData *);
+    acul::point2D<i32> get_window_size(const Window &window);
+    acul::string get_clipboard_string();
+    void set_clipboard_string(const acul::string &text);
+    MonitorInfo get_primary_monitor_info();
+
+    bool create_window(WindowData *window_data, const acul::string &title, i32 width, i32 height,
+                       WindowFlags flags);
+    void destroy(WindowData *window_data);
+    void set_window_icon(WindowData *, const acul::vector<Image> &);
+    void show_window(WindowData *window_data);
+    void hide_window(WindowData *window_data);
+    acul::string get_window_title(WindowData *window_data);
+    void set_window_title(WindowData *window_data, const acul::string &title);
+    void enable_fullscreen(WindowData *window_data);
+    void disable_fullscreen(WindowData *window_data);
+    acul::point2D<i32> get_cursor_position(WindowData *window_data);
+    void set_cursor_position(WindowData *window_data, acul::point2D<i32> position);
+    void hide_cursor(WindowData *window_data);
+    void show_cursor(Window *, WindowData *window_data);
+    acul::point2D<i32> get_window_position(WindowData *window);
+    void set_window_position(WindowData *window, acul::point2D<i32> position);
+    void center_window(WindowData *window);
+    void update_resize_limit(WindowData *window);
+    void minimize_window(WindowData *window);
+    void maximize_window(WindowData *window);
+
+    Cursor::Platform *create_cursor(Cursor::Type);
+    void assign_cursor(Window *, Cursor::Platform *);
+    void destroy_cursor(Cursor::Platform *);
+    bool is_cursor_valid(const Cursor::Platform *);
+
+    SoftwareSurface::Platform *create_software_surface(WindowData *window_data, u32 buffer_count);
+    bool acquire_software_buffer(SoftwareSurface::Platform *pd, SoftwareSurface::Buffer &buffer);
+    void present_software_buffer(SoftwareSurface::Platform *pd, std::span<const DamageRect> damage);
+    void destroy_software_surface(SoftwareSurface::Platform *pd);
+} // namespace awin::platform::headless
@@ -3,6 +3,7 @@
 #include <X11/X.h>
 #include <acul/string/string.hpp>
 #include <acul/vector.hpp>
+#include <awin/software.hpp>
 #include <awin/types.hpp>
 #include <sys/poll.h>
 
@@ -15,10 +16,30 @@ namespace awin
 
     inline Cursor::Platform *get_cursor_pd(Cursor *cursor) { return cursor->_pd; }
 
+    // Common state of the software surfaces, extended by each backend
+    struct SoftwareSurface::Platform
+    {
+        WindowData *window;
+        u64 presents = 0;  // Frames presented so far
+        int acquired = -1; // Buffer taken by the last acquire, -1 if none
+
+        virtual ~Platform() = default;
+
+        // Age of a buffer last presented as frame `presented`, 0 if it was never presented
+        u32 buffer_age(u64 presented) const { return presented ? (u32)(presents - presented + 1) : 0; }
+    };
+
     namespace platform
     {
         bool poll_posix(struct pollfd *fds, nfds_t count, f64 *timeout);
 
+        // Same as poll_posix with the descriptors watched by the application added to the set. `watched` is set
+        // when one of them is ready. The watches are left to the polling thread when the event thread is running.
+        bool poll_watched(struct pollfd *fds, nfds_t count, f64 *timeout, bool &watched);
+
+        // Invoke the callbacks of the watched descriptors that are ready
+        void dispatch_fd_watches();
+
         struct LinuxWindowCaller
         {
             bool (*create_window)(WindowData *, const acul::string &, i32, i32, WindowFlags);
@@ -30,6 +51,7 @@ namespace awin
             void (*enable_fullscreen)(WindowData *);
             void (*disable_fullscreen)(WindowData *);
             acul::point2D<i32> (*get_cursor_position)(WindowData *);
+            acul::point2D<i32> (*query_cursor_position)(WindowData *);
             void (*set_cursor_position)(WindowData *, acul::point2D<i32>);
             void (*hide_cursor)(WindowData *);
             void (*show_cursor)(Window *, WindowData *);
@@ -49,13 +71,23 @@ namespace awin
             WindowData *(*alloc_window_data)();
             void (*poll_events)();
             void (*wait_events)();
-            void (*wait_events_timeout)();
-            void (*push_empty_event)();
+            void (*wait_events_timeout)(f64 timeout);
+            void (*get_event_fds)(acul::vector<int> &fds);
             f32 (*get_dpi)(WindowData *);
             acul::point2D<i32> (*get_window_size)(const Window &);
             acul::string (*get_clipboard_string)();
             void (*set_clipboard_string)(const acul::string &);
             MonitorInfo (*get_primary_monitor_info)();
+            void (*begin_batch)(); // Optional, for backends that buffer requests
+            void (*end_batch)();
+        };
+
+        struct LinuxSoftwareCaller
+        {
+            SoftwareSurface::Platform *(*create)(WindowData *, u32 buffer_count) = NULL;
+            bool (*acquire)(SoftwareSurface::Platform *, SoftwareSurface::Buffer &) = NULL;
+            void (*present)(SoftwareSurface::Platform *, std::span<const DamageRect>) = NULL;
+            void (*destroy)(SoftwareSurface::Platform *) = NULL;
         };
 
         struct LinuxCursorCaller
@@ -66,6 +98,16 @@ namespace awin
             bool (*valid)(const Cursor::Platform *) = NULL;
         };
 
+        // Callers of the active window backend
+        extern struct PlatformDataDispatcher
+        {
+            int backend_type;
+            LinuxPlatformCaller pcall;
+            LinuxWindowCaller wcall;
+            LinuxCursorCaller ccall;
+            LinuxSoftwareCaller scall;
+        } pd;
+
         void init_call_cdata(LinuxCursorCaller &caller);
 
         void sync_mods_by_key(io::Key key, io::KeyMode &mods);
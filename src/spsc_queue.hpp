@@ -0,0 +1,63 @@
+#pragma once
+#include <acul/scalars.hpp>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace awin
+{
+    namespace platform
+    {
+        // Bounded lock-free queue for exactly one producer thread and one consumer thread.
+        // Capacity must be a power of two.
+        template <typename T, size_t Capacity>
+        class SpscQueue
+        {
+            static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+        public:
+            // Producer: append a value. Returns false if the queue is full.
+            bool push(const T &value)
+            {
+                const size_t tail = _tail.load(std::memory_order_relaxed);
+                if (tail - _head_cache == Capacity)
+                {
+                    _head_cache = _head.load(std::memory_order_acquire);
+                    if (tail - _head_cache == Capacity) return false;
+                }
+                _items[tail & (Capacity - 1)] = value;
+                _tail.store(tail + 1, std::memory_order_release);
+                return true;
+            }
+
+            // Consumer: take the oldest value. Returns false if the queue is empty.
+            bool pop(T &value)
+            {
+                const size_t head = _head.load(std::memory_order_relaxed);
+                if (head == _tail_cache)
+                {
+                    _tail_cache = _tail.load(std::memory_order_acquire);
+                    if (head == _tail_cache) return false;
+                }
+                value = std::move(_items[head & (Capacity - 1)]);
+                _head.store(head + 1, std::memory_order_release);
+                return true;
+            }
+
+            // Consumer: check if there is nothing to take.
+            bool empty() const
+            {
+                return _head.load(std::memory_order_relaxed) == _tail.load(std::memory_order_acquire);
+            }
+
+        private:
+            // Producer and consumer indices live on separate cache lines, each side keeps a cached copy of the
+            // other index to avoid touching the shared line on every call.
+            alignas(64) std::atomic<size_t> _head{0};
+            size_t _tail_cache{0};
+            alignas(64) std::atomic<size_t> _tail{0};
+            size_t _head_cache{0};
+            alignas(64) T _items[Capacity];
+        };
+    } // namespace platform
+} // namespace awin
@@ -0,0 +1,493 @@
+#include <awin/trace.hpp>
+#include <cstdio>
+#include <cstring>
+#include "env.hpp"
+
+namespace awin::trace
+{
+    namespace
+    {
+        constexpr char magic[4] = {'A', 'W', 'T', 'R'};
+        constexpr u16 version = 1;
+        constexpr size_t header_size = sizeof(magic) + sizeof(u16) * 2;
+        constexpr u8 no_window = 0xFF;
+
+        enum class Kind : u8
+        {
+            focus,
+            char_input,
+            key_input,
+            mouse_click,
+            mouse_enter,
+            mouse_move_delta,
+            mouse_move,
+            scroll,
+            dpi_changed,
+            minimize,
+            maximize,
+            resize,
+            move,
+            live_resize,
+            count
+        };
+
+        template <typename T>
+        inline void put(acul::vector<u8> &data, T value)
+        {
+            const size_t offset = data.size();
+            data.resize(offset + sizeof(T));
+            memcpy(data.data() + offset, &value, sizeof(T));
+        }
+
+        struct Reader
+        {
+            const acul::vector<u8> &data;
+            size_t &offset;
+
+            template <typename T>
+            T get()
+            {
+                T value;
+                memcpy(&value, data.data() + offset, sizeof(T));
+                offset += sizeof(T);
+                return value;
+            }
+        };
+
+        constexpr io::KeyModeBits::enum_type mod_bits[] = {io::KeyModeBits::shift,     io::KeyModeBits::control,
+                                                           io::KeyModeBits::alt,       io::KeyModeBits::super,
+                                                           io::KeyModeBits::caps_lock, io::KeyModeBits::num_lock};
+
+        inline u8 pack_mods(io::KeyMode mods)
+        {
+            u8 bits = 0;
+            for (auto bit : mod_bits)
+                if (mods & bit) bits |= static_cast<u8>(bit);
+            return bits;
+        }
+
+        inline io::KeyMode unpack_mods(u8 bits)
+        {
+            io::KeyMode mods{};
+            for (auto bit : mod_bits)
+                if (bits & static_cast<u8>(bit)) mods |= bit;
+            return mods;
+        }
+
+        // Size of the record payload following the common record header
+        size_t payload_size(Kind kind)
+        {
+            switch (kind)
+            {
+                case Kind::focus:
+                case Kind::mouse_enter:
+                case Kind::minimize:
+                case Kind::maximize:
+                case Kind::live_resize:
+                    return sizeof(u8);
+                case Kind::char_input:
+                    return sizeof(u32);
+                case Kind::key_input:
+                    return sizeof(i16) + sizeof(i8) + sizeof(u8);
+                case Kind::mouse_click:
+                    return sizeof(i8) * 2 + sizeof(u8);
+                case Kind::mouse_move_delta:
+                    return sizeof(f64) * 2 + sizeof(i32) * 2 + sizeof(u32);
+                case Kind::mouse_move:
+                case Kind::resize:
+                case Kind::move:
+                    return sizeof(i32) * 2 + sizeof(u32);
+                case Kind::scroll:
+                case Kind::dpi_changed:
+                    return sizeof(f32) * 2;
+                default:
+                    return 0;
+            }
+        }
+
+        // Events of the kind carry the display server timestamp of InputEvent
+        inline bool has_server_time(Kind kind)
+        {
+            switch (kind)
+            {
+                case Kind::focus:
+                case Kind::dpi_changed:
+                case Kind::minimize:
+                case Kind::maximize:
+                case Kind::live_resize:
+                    return false;
+                default:
+                    return true;
+            }
+        }
+
+        constexpr size_t record_header_size = sizeof(u8) * 2 + sizeof(f64) + sizeof(u32);
+    } // namespace
+
+    void Recorder::start()
+    {
+        assert(platform::g_env);
+        if (_data.empty())
+        {
+            for (char c : magic) put<u8>(_data, static_cast<u8>(c));
+            put<u16>(_data, version);
+            put<u16>(_data, 0);
+            _start = get_time();
+        }
+        platform::g_env->recorder = this;
+    }
+
+    void Recorder::stop()
+    {
+        if (recording()) platform::g_env->recorder = nullptr;
+    }
+
+    bool Recorder::recording() const { return platform::g_env && platform::g_env->recorder == this; }
+
+    void Recorder::clear()
+    {
+        _data.clear();
+        _windows.clear();
+        if (recording()) start();
+    }
+
+    bool Recorder::save(const char *path) const
+    {
+        FILE *file = fopen(path, "wb");
+        if (!file)
+        {
+            AWIN_LOG_ERROR("Failed to open trace file: %s", path);
+            return false;
+        }
+        const bool written = fwrite(_data.data(), 1, _data.size(), file) == _data.size();
+        fclose(file);
+        if (!written) AWIN_LOG_ERROR("Failed to write trace file: %s", path);
+        return written;
+    }
+
+    void Recorder::record(const acul::events::event &event)
+    {
+        Kind kind;
+        Window *window;
+        switch (event.id)
+        {
+            case event_id::focus:
+                kind = Kind::focus;
+                window = static_cast<const FocusEvent &>(event).window;
+                break;
+            case event_id::char_input:
+                kind = Kind::char_input;
+                window = static_cast<const CharInputEvent &>(event).window;
+                break;
+            case event_id::key_input:
+                kind = Kind::key_input;
+                window = static_cast<const KeyInputEvent &>(event).window;
+                break;
+            case event_id::mouse_click:
+                kind = Kind::mouse_click;
+                window = static_cast<const MouseClickEvent &>(event).window;
+                break;
+            case event_id::mouse_enter:
+                kind = Kind::mouse_enter;
+                window = static_cast<const MouseEnterEvent &>(event).window;
+                break;
+            case event_id::mouse_move_delta:
+                kind = Kind::mouse_move_delta;
+                window = static_cast<const DeltaEvent &>(event).window;
+                break;
+            case event_id::mouse_move:
+                kind = Kind::mouse_move;
+                window = static_cast<const PosEvent &>(event).window;
+                break;
+            case event_id::scroll:
+                kind = Kind::scroll;
+                window = static_cast<const ScrollEvent &>(event).window;
+                break;
+            case event_id::dpi_changed:
+                kind = Kind::dpi_changed;
+                window = static_cast<const DpiChangedEvent &>(event).window;
+                break;
+            case event_id::minimize:
+                kind = Kind::minimize;
+                window = static_cast<const StateEvent &>(event).window;
+                break;
+            case event_id::maximize:
+                kind = Kind::maximize;
+                window = static_cast<const StateEvent &>(event).window;
+                break;
+            case event_id::resize:
+                kind = Kind::resize;
+                window = static_cast<const PosEvent &>(event).window;
+                break;
+            case event_id::move:
+                kind = Kind::move;
+                window = static_cast<const PosEvent &>(event).window;
+                break;
+            case event_id::live_resize:
+                kind = Kind::live_resize;
+                window = static_cast<const StateEvent &>(event).window;
+                break;
+            default:
+                return;
+        }
+
+        u8 index = no_window;
+        if (window)
+        {
+            size_t i = 0;
+            while (i < _windows.size() && _windows[i] != window) ++i;
+            if (i == _windows.size() && i < no_window) _windows.push_back(window);
+            if (i < no_window) index = static_cast<u8>(i);
+        }
+
+        put<u8>(_data, static_cast<u8>(kind));
+        put<u8>(_data, index);
+        put<f64>(_data, get_time() - _start);
+        put<u32>(_data, has_server_time(kind) ? static_cast<const InputEvent &>(event).server_time : 0);
+
+        switch (kind)
+        {
+            case Kind::focus:
+                put<u8>(_data, static_cast<const FocusEvent &>(event).focused);
+                break;
+            case Kind::mouse_enter:
+                put<u8>(_data, static_cast<const MouseEnterEvent &>(event).entered);
+                break;
+            case Kind::minimize:
+            case Kind::maximize:
+            case Kind::live_resize:
+                put<u8>(_data, static_cast<const StateEvent &>(event).state);
+                break;
+            case Kind::char_input:
+                put<u32>(_data, static_cast<const CharInputEvent &>(event).char_code);
+                break;
+            case Kind::key_input:
+            {
+                const auto &e = static_cast<const KeyInputEvent &>(event);
+                put<i16>(_data, static_cast<i16>(e.key));
+                put<i8>(_data, static_cast<i8>(e.action));
+                put<u8>(_data, pack_mods(e.mods));
+                break;
+            }
+            case Kind::mouse_click:
+            {
+                const auto &e = static_cast<const MouseClickEvent &>(event);
+                put<i8>(_data, static_cast<i8>(e.button));
+                put<i8>(_data, static_cast<i8>(e.action));
+                put<u8>(_data, pack_mods(e.mods));
+                break;
+            }
+            case Kind::mouse_move_delta:
+            {
+                const auto &e = static_cast<const DeltaEvent &>(event);
+                put<f64>(_data, e.delta.x);
+                put<f64>(_data, e.delta.y);
+                put<i32>(_data, e.steps.x);
+                put<i32>(_data, e.steps.y);
+                put<u32>(_data, e.count);
+                break;
+            }
+            case Kind::mouse_move:
+            case Kind::resize:
+            case Kind::move:
+            {
+                const auto &e = static_cast<const PosEvent &>(event);
+                put<i32>(_data, e.position.x);
+                put<i32>(_data, e.position.y);
+                put<u32>(_data, e.count);
+                break;
+            }
+            case Kind::scroll:
+            {
+                const auto &e = static_cast<const ScrollEvent &>(event);
+                put<f32>(_data, e.h);
+                put<f32>(_data, e.v);
+                break;
+            }
+            case Kind::dpi_changed:
+            {
+                const auto &e = static_cast<const DpiChangedEvent &>(event);
+                put<f32>(_data, e.dpi.x);
+                put<f32>(_data, e.dpi.y);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    bool Replayer::load(const char *path)
+    {
+        FILE *file = fopen(path, "rb");
+        if (!file)
+        {
+            AWIN_LOG_ERROR("Failed to open trace file: %s", path);
+            return false;
+        }
+        acul::vector<u8> data;
+        u8 buffer[4096];
+        size_t read;
+        while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        {
+            const size_t offset = data.size();
+            data.resize(offset + read);
+            memcpy(data.data() + offset, buffer, read);
+        }
+        fclose(file);
+        return load(data);
+    }
+
+    bool Replayer::load(const acul::vector<u8> &data)
+    {
+        _data.clear();
+        _offset = 0;
+        if (data.size() < header_size || memcmp(data.data(), magic, sizeof(magic)) != 0)
+        {
+            AWIN_LOG_ERROR("Invalid event trace");
+            return false;
+        }
+        u16 trace_version;
+        memcpy(&trace_version, data.data() + sizeof(magic), sizeof(u16));
+        if (trace_version != version)
+        {
+            AWIN_LOG_ERROR("Unsupported event trace version: %u", trace_version);
+            return false;
+        }
+
+        // Validate the record stream once so that update() can read without bounds checks
+        size_t offset = header_size;
+        while (offset < data.size())
+        {
+            const u8 kind = data[offset];
+            if (kind >= static_cast<u8>(Kind::count) ||
+                offset + record_header_size + payload_size(static_cast<Kind>(kind)) > data.size())
+            {
+                AWIN_LOG_ERROR("Corrupted event trace at offset %zu", offset);
+                return false;
+            }
+            offset += record_header_size + payload_size(static_cast<Kind>(kind));
+        }
+
+        _data = data;
+        _offset = header_size;
+        return true;
+    }
+
+    void Replayer::start(const acul::vector<Window *> &windows, bool realtime)
+    {
+        _windows = windows;
+        _realtime = realtime;
+        _start = get_time();
+        if (_data.size() >= header_size) _offset = header_size;
+    }
+
+    bool Replayer::update()
+    {
+        using namespace platform;
+        const f64 elapsed = get_time() - _start;
+        auto &events = g_env->events;
+        Reader reader{_data, _offset};
+
+        while (!finished())
+        {
+            f64 time;
+            memcpy(&time, _data.data() + _offset + sizeof(u8) * 2, sizeof(f64));
+            if (_realtime && time > elapsed) break;
+
+            const Kind kind = static_cast<Kind>(reader.get<u8>());
+            const u8 index = reader.get<u8>();
+            reader.get<f64>();
+            const u32 server_time = reader.get<u32>();
+            Window *window = index < _windows.size() ? _windows[index] : nullptr;
+            if (!window)
+            {
+                _offset += payload_size(kind);
+                continue;
+            }
+
+            // Replayed events carry the recorded server timestamp
+            EventTimeScope time_scope(server_time);
+
+            switch (kind)
+            {
+                case Kind::focus:
+                    dispatch_event<FocusEvent>(events.focus, window, reader.get<u8>() != 0);
+                    break;
+                case Kind::mouse_enter:
+                    dispatch_event<MouseEnterEvent>(events.mouse_enter, window, reader.get<u8>() != 0);
+                    break;
+                case Kind::minimize:
+                    dispatch_event<StateEvent>(events.minimize, event_id::minimize, window, reader.get<u8>() != 0);
+                    break;
+                case Kind::maximize:
+                    dispatch_event<StateEvent>(events.maximize, event_id::maximize, window, reader.get<u8>() != 0);
+                    break;
+                case Kind::live_resize:
+                    dispatch_event<StateEvent>(events.live_resize, event_id::live_resize, window,
+                                               reader.get<u8>() != 0);
+                    break;
+                case Kind::char_input:
+                    dispatch_event<CharInputEvent>(events.char_input, window, reader.get<u32>());
+                    break;
+                case Kind::key_input:
+                {
+                    const auto key = static_cast<io::Key>(reader.get<i16>());
+                    const auto action = static_cast<io::KeyPressState>(reader.get<i8>());
+                    dispatch_event<KeyInputEvent>(events.key_input, window, key, action, unpack_mods(reader.get<u8>()));
+                    break;
+                }
+                case Kind::mouse_click:
+                {
+                    const auto button = static_cast<io::MouseKey>(reader.get<i8>());
+                    const auto action = static_cast<io::KeyPressState>(reader.get<i8>());
+                    dispatch_event<MouseClickEvent>(events.mouse_click, window, button, action,
+                                                    unpack_mods(reader.get<u8>()));
+                    break;
+                }
+                case Kind::mouse_move_delta:
+                {
+                    acul::point2D<f64> delta;
+                    delta.x = reader.get<f64>();
+                    delta.y = reader.get<f64>();
+                    acul::point2D<i32> steps;
+                    steps.x = reader.get<i32>();
+                    steps.y = reader.get<i32>();
+                    dispatch_event<DeltaEvent>(events.mouse_move_delta, window, delta, steps, reader.get<u32>());
+                    break;
+                }
+                case Kind::mouse_move:
+                case Kind::resize:
+                case Kind::move:
+                {
+                    acul::point2D<i32> position;
+                    position.x = reader.get<i32>();
+                    position.y = reader.get<i32>();
+                    const u32 count = reader.get<u32>();
+                    if (kind == Kind::mouse_move)
+                        dispatch_event<PosEvent>(events.mouse_move, event_id::mouse_move, window, position, count);
+                    else if (kind == Kind::resize)
+                        dispatch_event<PosEvent>(events.resize, event_id::resize, window, position, count);
+                    else
+                        dispatch_event<PosEvent>(events.move, event_id::move, window, position, count);
+                    break;
+                }
+                case Kind::scroll:
+                {
+                    const f32 h = reader.get<f32>();
+                    dispatch_event<ScrollEvent>(events.scroll, window, h, reader.get<f32>());
+                    break;
+                }
+                case Kind::dpi_changed:
+                {
+                    const f32 x = reader.get<f32>();
+                    dispatch_event<DpiChangedEvent>(events.dpi_changed, window, x, reader.get<f32>());
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+        deliver_batched_events();
+        return !finished();
+    }
+} // namespace awin::trace
@@ -0,0 +1,28 @@
+#pragma once
+#include <atomic>
+
+namespace awin
+{
+    namespace platform
+    {
+        // Descriptor that wakes a thread waiting in poll from any other thread. Signals are coalesced until the
+        // waiting thread drains them, so only the first of any number of wakeups writes to the descriptor.
+        struct WakeEvent
+        {
+            int fd = -1;
+            std::atomic<bool> pending{false};
+        };
+
+        // Create the eventfd of the wake event
+        bool create_wake_event(WakeEvent &wake);
+
+        // Close the eventfd of the wake event
+        void destroy_wake_event(WakeEvent &wake);
+
+        // Make the descriptor readable. Can be called from any thread.
+        void signal_wake_event(WakeEvent &wake);
+
+        // Consume the pending signal. Called by the waiting thread before it processes events.
+        void drain_wake_event(WakeEvent &wake);
+    } // namespace platform
+} // namespace awin
@@ -73,8 +73,7 @@ namespace awin::platform::wayland
         {
             window->buffer_scale = max_scale;
             wl_surface_set_buffer_scale(window->surface, max_scale);
-            acul::events::dispatch_event_group<DpiChangedEvent>(g_env->events.dpi_changed, window->owner, max_scale,
-                                                                max_scale);
+            dispatch_event<DpiChangedEvent>(g_env->events.dpi_changed, window->owner, max_scale, max_scale);
         }
     }
 
@@ -139,7 +138,7 @@ namespace awin::platform::wayland
         if (strcmp(interface, "wl_compositor") == 0)
         {
             g_ctx->compositor =
-                (wl_compositor *)wl_registry_bind(registry, name, &wl_compositor_interface, std::min(3U, version));
+                (wl_compositor *)wl_registry_bind(registry, name, &wl_compositor_interface, std::min(4U, version));
         }
         else if (strcmp(interface, "wl_subcompositor") == 0)
             g_ctx->subcompositor = (wl_subcompositor *)wl_registry_bind(registry, name, &wl_subcompositor_interface, 1);
@@ -152,6 +151,8 @@ namespace awin::platform::wayland
             if (!g_ctx->seat)
             {
                 g_ctx->seat = (wl_seat *)wl_registry_bind(registry, name, &wl_seat_interface, std::min(4U, version));
+                // The pointer and keyboard created from the seat inherit its queue
+                if (g_ctx->input_queue) wl_proxy_set_queue((wl_proxy *)g_ctx->seat, g_ctx->input_queue);
                 add_seat_listener(g_ctx->seat);
 
                 if (wl_seat_get_version(g_ctx->seat) >= WL_KEYBOARD_REPEAT_INFO_SINCE_VERSION)
@@ -175,8 +176,12 @@ namespace awin::platform::wayland
         else if (strcmp(interface, "wp_viewporter") == 0)
             g_ctx->viewporter = (wp_viewporter *)wl_registry_bind(registry, name, &wp_viewporter_interface, 1);
         else if (strcmp(interface, "zwp_relative_pointer_manager_v1") == 0)
+        {
             g_ctx->relative_pointer_manager = (zwp_relative_pointer_manager_v1 *)wl_registry_bind(
                 registry, name, &zwp_relative_pointer_manager_v1_interface, 1);
+            if (g_ctx->input_queue)
+                wl_proxy_set_queue((wl_proxy *)g_ctx->relative_pointer_manager, g_ctx->input_queue);
+        }
         else if (strcmp(interface, "zwp_idle_inhibit_manager_v1") == 0)
             g_ctx->idle_inhibit_manager = (zwp_idle_inhibit_manager_v1 *)wl_registry_bind(
                 registry, name, &zwp_idle_inhibit_manager_v1_interface, 1);
@@ -281,6 +286,10 @@ namespace awin::platform::wayland
             return false;
         }
 
+        if (wl_display_create_queue && wl_display_dispatch_queue_pending && wl_event_queue_destroy &&
+            wl_proxy_set_queue)
+            g_ctx->input_queue = wl_display_create_queue(g_ctx->display);
+
         g_ctx->registry = wl_display_get_registry(g_ctx->display);
         wl_registry_add_listener(g_ctx->registry, &registry_listener, NULL);
 
@@ -293,6 +302,8 @@ namespace awin::platform::wayland
 
         wl_display_roundtrip(g_ctx->display); // Sync so we got all registry objects
         wl_display_roundtrip(g_ctx->display); // Sync so we got all initial output events
+        // The roundtrips only dispatch the default queue, the seat capabilities wait on the input queue
+        if (g_ctx->input_queue) wl_display_dispatch_queue_pending(g_ctx->display, g_ctx->input_queue);
 
         if (g_ctx->wl.libdecor.handle)
         {
@@ -359,6 +370,7 @@ namespace awin::platform::wayland
         if (g_ctx->cursor_surface) wl_surface_destroy(g_ctx->cursor_surface);
         if (g_ctx->subcompositor) wl_subcompositor_destroy(g_ctx->subcompositor);
         if (g_ctx->compositor) wl_compositor_destroy(g_ctx->compositor);
+        destroy_shm_pool();
         if (g_ctx->shm) wl_shm_destroy(g_ctx->shm);
         if (g_ctx->viewporter) wp_viewporter_destroy(g_ctx->viewporter);
         if (g_ctx->decoration_manager) zxdg_decoration_manager_v1_destroy(g_ctx->decoration_manager);
@@ -370,6 +382,7 @@ namespace awin::platform::wayland
         if (g_ctx->pointer) wl_pointer_destroy(g_ctx->pointer);
         if (g_ctx->keyboard) wl_keyboard_destroy(g_ctx->keyboard);
         if (g_ctx->seat) wl_seat_destroy(g_ctx->seat);
+        if (g_ctx->input_queue) wl_event_queue_destroy(g_ctx->input_queue);
         if (g_ctx->relative_pointer_manager) zwp_relative_pointer_manager_v1_destroy(g_ctx->relative_pointer_manager);
         if (g_ctx->idle_inhibit_manager) zwp_idle_inhibit_manager_v1_destroy(g_ctx->idle_inhibit_manager);
         if (g_ctx->fractional_scale_manager) wp_fractional_scale_manager_v1_destroy(g_ctx->fractional_scale_manager);
@@ -397,7 +410,7 @@ namespace awin::platform::wayland
         caller.poll_events = poll_events;
         caller.wait_events = wait_events;
         caller.wait_events_timeout = wait_events_timeout;
-        caller.push_empty_event = push_empty_event;
+        caller.get_event_fds = get_event_fds;
         caller.get_dpi = get_dpi;
         caller.get_window_size = get_window_size;
         caller.get_clipboard_string = get_clipboard_string;
@@ -417,6 +430,7 @@ namespace awin::platform::wayland
         caller.enable_fullscreen = enable_fullscreen;
         caller.disable_fullscreen = disable_fullscreen;
         caller.get_cursor_position = get_cursor_position;
+        caller.query_cursor_position = get_cursor_position;
         caller.set_cursor_position = set_cursor_position;
         caller.hide_cursor = hide_cursor;
         caller.show_cursor = show_cursor;
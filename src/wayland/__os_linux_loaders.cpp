@@ -29,6 +29,10 @@ namespace awin::platform::wayland
         LOAD_FUNCTION(wl_display_roundtrip, handle);
         LOAD_FUNCTION(wl_display_get_fd, handle);
         LOAD_FUNCTION(wl_display_prepare_read, handle);
+        LOAD_FUNCTION(wl_display_create_queue, handle);
+        LOAD_FUNCTION(wl_display_dispatch_queue_pending, handle);
+        LOAD_FUNCTION(wl_event_queue_destroy, handle);
+        LOAD_FUNCTION(wl_proxy_set_queue, handle);
         LOAD_FUNCTION(wl_proxy_marshal, handle);
         LOAD_FUNCTION(wl_proxy_add_listener, handle);
         LOAD_FUNCTION(wl_proxy_destroy, handle);
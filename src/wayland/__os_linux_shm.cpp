@@ -0,0 +1,269 @@
+#include <algorithm>
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "../env.hpp"
+#include "generators/redifinition.h"
+#include "platform.hpp"
+//
+#include "wayland-client-protocol.h"
+
+#define AWIN_SHM_POOL_MIN_SIZE (64 * 1024)
+#define AWIN_SHM_ALIGNMENT     64
+
+namespace awin::platform::wayland
+{
+    static int create_tmpfile_cloexec(char *tmpname)
+    {
+        int fd;
+
+        fd = mkostemp(tmpname, O_CLOEXEC);
+        if (fd >= 0) unlink(tmpname);
+
+        return fd;
+    }
+
+    static int create_anonymous_file(off_t size)
+    {
+        static acul::string _template = "/awin-shared-XXXXXX";
+        const char *path;
+        int fd;
+        int ret;
+
+        // The pool only grows, so shrinking is sealed off for the compositor
+        fd = memfd_create("awin-shared", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        if (fd >= 0)
+            fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_SEAL);
+        else
+        {
+            path = getenv("XDG_RUNTIME_DIR");
+            if (!path)
+            {
+                errno = ENOENT;
+                return -1;
+            }
+
+            acul::string name{path};
+            name += _template;
+
+            fd = create_tmpfile_cloexec((char *)name.c_str());
+            if (fd < 0) return -1;
+        }
+
+        ret = posix_fallocate(fd, 0, size);
+        if (ret != 0)
+        {
+            close(fd);
+            errno = ret;
+            return -1;
+        }
+        return fd;
+    }
+
+    static void buffer_handle_release(void *user_data, wl_buffer *buffer)
+    {
+        static_cast<ShmBuffer *>(user_data)->busy = false;
+    }
+
+    static const struct wl_buffer_listener buffer_listener = {buffer_handle_release};
+
+    static bool create_pool(ShmPool &pool, i32 capacity)
+    {
+        pool.fd = create_anonymous_file(capacity);
+        if (pool.fd < 0)
+        {
+            AWIN_LOG_ERROR("Wayland: Failed to create buffer file of size %d: %s", capacity, strerror(errno));
+            return false;
+        }
+
+        void *data = mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, pool.fd, 0);
+        if (data == MAP_FAILED)
+        {
+            AWIN_LOG_ERROR("Wayland: Failed to map file: %s", strerror(errno));
+            close(pool.fd);
+            pool.fd = -1;
+            return false;
+        }
+
+        pool.handle = wl_shm_create_pool(g_ctx->shm, pool.fd, capacity);
+        pool.data = (u8 *)data;
+        pool.capacity = capacity;
+        pool.used = 0;
+        return true;
+    }
+
+    static bool grow_pool(ShmPool &pool, i64 required)
+    {
+        // wl_shm_pool sizes are 32 bit
+        if (required > INT32_MAX)
+        {
+            AWIN_LOG_ERROR("Wayland: Buffer pool of %lld bytes exceeds the protocol limit", (long long)required);
+            return false;
+        }
+        i64 capacity = pool.capacity;
+        while (capacity < required) capacity *= 2;
+        capacity = std::min<i64>(capacity, INT32_MAX);
+
+        const int ret = posix_fallocate(pool.fd, 0, capacity);
+        if (ret != 0)
+        {
+            AWIN_LOG_ERROR("Wayland: Failed to grow buffer file to %lld: %s", (long long)capacity, strerror(ret));
+            return false;
+        }
+
+        // The file is mapped again instead of moving the old mapping, so the pixels handed out before stay valid
+        void *data = mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, pool.fd, 0);
+        if (data == MAP_FAILED)
+        {
+            AWIN_LOG_ERROR("Wayland: Failed to map file: %s", strerror(errno));
+            return false;
+        }
+        pool.retired.push_back({pool.data, pool.capacity});
+
+        // The compositor maps the new size with the resize, buffers created before keep their offsets
+        wl_shm_pool_resize(pool.handle, (i32)capacity);
+        pool.data = (u8 *)data;
+        pool.capacity = (i32)capacity;
+        return true;
+    }
+
+    // Give a range back to the free list, merged with its neighbours. A range reaching 'used' shrinks it instead.
+    static void free_range(ShmPool &pool, ShmRange range)
+    {
+        auto &free = pool.free;
+        auto it = std::lower_bound(free.begin(), free.end(), range.offset,
+                                   [](const ShmRange &r, i32 offset) { return r.offset < offset; });
+        if (it != free.end() && range.offset + range.size == it->offset)
+        {
+            range.size += it->size;
+            it = free.erase(it);
+        }
+        if (it != free.begin() && (it - 1)->offset + (it - 1)->size == range.offset)
+        {
+            --it;
+            range.offset = it->offset;
+            range.size += it->size;
+            it = free.erase(it);
+        }
+        if (range.offset + range.size == pool.used)
+            pool.used = range.offset;
+        else
+            free.insert(it, range);
+    }
+
+    // Destroy the returned buffers the compositor no longer reads from, except those of the requested size
+    static void reclaim_buffers(ShmPool &pool, acul::point2D<i32> keep)
+    {
+        for (size_t i = 0; i < pool.buffers.size();)
+        {
+            ShmBuffer *buffer = pool.buffers[i];
+            if (!buffer->returned || buffer->busy || buffer->dimensions == keep)
+            {
+                ++i;
+                continue;
+            }
+            wl_buffer_destroy(buffer->handle);
+            free_range(pool, {buffer->offset, buffer->size});
+            acul::release(buffer);
+            pool.buffers.erase(pool.buffers.begin() + i);
+        }
+    }
+
+    // Take the smallest free range that fits, or the space past 'used'. Returns -1 if the pool cannot hold it.
+    static i32 allocate_range(ShmPool &pool, i32 size)
+    {
+        auto &free = pool.free;
+        auto fit = free.end();
+        for (auto it = free.begin(); it != free.end(); ++it)
+            if (it->size >= size && (fit == free.end() || it->size < fit->size)) fit = it;
+        if (fit != free.end())
+        {
+            const i32 offset = fit->offset;
+            if (fit->size == size)
+                free.erase(fit);
+            else
+            {
+                fit->offset += size;
+                fit->size -= size;
+            }
+            return offset;
+        }
+
+        const i64 end = (i64)pool.used + size;
+        if (end > pool.capacity && !grow_pool(pool, end)) return -1;
+        const i32 offset = pool.used;
+        pool.used = (i32)end;
+        return offset;
+    }
+
+    static void create_buffer_handle(ShmPool &pool, ShmBuffer *buffer)
+    {
+        const auto &size = buffer->dimensions;
+        buffer->handle =
+            wl_shm_pool_create_buffer(pool.handle, buffer->offset, size.x, size.y, size.x * 4, WL_SHM_FORMAT_ARGB8888);
+        wl_buffer_add_listener(buffer->handle, &buffer_listener, buffer);
+    }
+
+    ShmBuffer *acquire_shm_buffer(acul::point2D<i32> dimensions)
+    {
+        auto &pool = g_ctx->shm_pool;
+        const i64 bytes = (i64)dimensions.x * dimensions.y * 4;
+        const i64 aligned = (bytes + AWIN_SHM_ALIGNMENT - 1) & ~(i64)(AWIN_SHM_ALIGNMENT - 1);
+        if (dimensions.x <= 0 || dimensions.y <= 0 || aligned > INT32_MAX)
+        {
+            AWIN_LOG_ERROR("Wayland: Invalid buffer size %dx%d", dimensions.x, dimensions.y);
+            return nullptr;
+        }
+        const i32 size = (i32)aligned;
+
+        // A returned buffer of the same size is handed out as is
+        for (auto *buffer : pool.buffers)
+        {
+            if (!buffer->returned || buffer->busy || !(buffer->dimensions == dimensions)) continue;
+            buffer->returned = false;
+            return buffer;
+        }
+        reclaim_buffers(pool, dimensions);
+
+        if (!pool.handle && !create_pool(pool, std::max(size, AWIN_SHM_POOL_MIN_SIZE))) return nullptr;
+        const i32 offset = allocate_range(pool, size);
+        if (offset < 0) return nullptr;
+
+        auto *buffer = acul::alloc<ShmBuffer>();
+        *buffer = {};
+        buffer->offset = offset;
+        buffer->size = size;
+        buffer->dimensions = dimensions;
+        create_buffer_handle(pool, buffer);
+        pool.buffers.push_back(buffer);
+        return buffer;
+    }
+
+    void attach_shm_buffer(wl_surface *surface, ShmBuffer *buffer)
+    {
+        wl_surface_attach(surface, buffer ? buffer->handle : NULL, 0, 0);
+        if (buffer) buffer->busy = true;
+    }
+
+    void release_shm_buffer(ShmBuffer *buffer) { buffer->returned = true; }
+
+    void destroy_shm_pool()
+    {
+        auto &pool = g_ctx->shm_pool;
+        for (auto *buffer : pool.buffers)
+        {
+            wl_buffer_destroy(buffer->handle);
+            acul::release(buffer);
+        }
+        pool.buffers.clear();
+        if (pool.handle)
+        {
+            wl_shm_pool_destroy(pool.handle);
+            munmap(pool.data, pool.capacity);
+            for (const auto &mapping : pool.retired) munmap(mapping.data, mapping.size);
+            close(pool.fd);
+        }
+        pool = {};
+    }
+} // namespace awin::platform::wayland
@@ -0,0 +1,134 @@
+#include <algorithm>
+#include "generators/redifinition.h"
+#include "platform.hpp"
+#include "window.hpp"
+//
+#include "wayland-client-protocol.h"
+
+// Software surfaces. The buffers come from the wl_shm pool of the connection and are attached to the window surface
+// directly. They have the framebuffer size of the window: the logical size times the integer buffer scale, with
+// fractional scaling the viewport of the window stretches the logical size to the output.
+namespace awin::platform::wayland
+{
+    struct WaylandSoftwareBuffer
+    {
+        ShmBuffer *shm;
+        u64 presented; // Frame the buffer was presented as, 0 if never
+    };
+
+    struct WaylandSoftwareSurface final : SoftwareSurface::Platform
+    {
+        acul::point2D<i32> size;
+        acul::vector<WaylandSoftwareBuffer> buffers;
+    };
+
+    static void release_buffers(WaylandSoftwareSurface *surface)
+    {
+        for (auto &buffer : surface->buffers)
+        {
+            // The compositor may still read a released buffer, the pool only reuses it after the release event
+            if (buffer.shm) release_shm_buffer(buffer.shm);
+            buffer = {};
+        }
+    }
+
+    static SoftwareSurface::Platform *create_software_surface(WindowData *window_data, u32 buffer_count)
+    {
+        auto *surface = acul::alloc<WaylandSoftwareSurface>();
+        surface->window = window_data;
+        surface->size = {0, 0};
+        // Compositors may hold the attached buffer until another one replaces it, a single buffer would stay busy
+        surface->buffers.resize(std::max(buffer_count, 2U));
+        for (auto &buffer : surface->buffers) buffer = {};
+        return surface;
+    }
+
+    static bool acquire_software_buffer(SoftwareSurface::Platform *pd, SoftwareSurface::Buffer &out)
+    {
+        auto *surface = (WaylandSoftwareSurface *)pd;
+        auto *wl_data = (WaylandWindowData *)surface->window;
+        const i32 scale = std::max(wl_data->buffer_scale, 1);
+        const acul::point2D<i32> size{wl_data->dimenstions.x * scale, wl_data->dimenstions.y * scale};
+        if (size.x <= 0 || size.y <= 0) return false;
+        if (!(surface->size == size))
+        {
+            release_buffers(surface);
+            surface->size = size;
+        }
+
+        // The free buffer shown longest ago
+        int index = -1;
+        for (int i = 0; i < (int)surface->buffers.size(); ++i)
+        {
+            const auto &buffer = surface->buffers[i];
+            if (buffer.shm && buffer.shm->busy) continue;
+            if (index == -1 || buffer.presented < surface->buffers[index].presented) index = i;
+        }
+        if (index == -1) return false;
+
+        auto &buffer = surface->buffers[index];
+        if (!buffer.shm)
+        {
+            buffer.shm = acquire_shm_buffer(size);
+            if (!buffer.shm) return false;
+        }
+        surface->acquired = index;
+        out.pixels = (u32 *)get_shm_pixels(buffer.shm);
+        out.stride = size.x;
+        out.size = size;
+        out.age = surface->buffer_age(buffer.presented);
+        return true;
+    }
+
+    static void present_software_buffer(SoftwareSurface::Platform *pd, std::span<const DamageRect> damage)
+    {
+        auto *surface = (WaylandSoftwareSurface *)pd;
+        auto *wl_data = (WaylandWindowData *)surface->window;
+        auto &buffer = surface->buffers[surface->acquired];
+        surface->acquired = -1;
+
+        attach_shm_buffer(wl_data->surface, buffer.shm);
+
+        // Damage in buffer coordinates needs wl_surface v4, older compositors take it in surface coordinates
+        const bool buffer_damage =
+            wl_proxy_get_version((wl_proxy *)wl_data->surface) >= WL_SURFACE_DAMAGE_BUFFER_SINCE_VERSION;
+        const i32 scale = std::max(wl_data->buffer_scale, 1);
+        const DamageRect full{0, 0, surface->size.x, surface->size.y};
+        if (damage.empty()) damage = {&full, 1};
+        for (const auto &rect : damage)
+        {
+            const i32 x = std::max(rect.x, 0), y = std::max(rect.y, 0);
+            const i32 right = std::min(rect.x + rect.width, surface->size.x);
+            const i32 bottom = std::min(rect.y + rect.height, surface->size.y);
+            if (right <= x || bottom <= y) continue;
+            if (buffer_damage)
+                wl_surface_damage_buffer(wl_data->surface, x, y, right - x, bottom - y);
+            else
+            {
+                const i32 sx = x / scale, sy = y / scale;
+                wl_surface_damage(wl_data->surface, sx, sy, (right + scale - 1) / scale - sx,
+                                  (bottom + scale - 1) / scale - sy);
+            }
+        }
+        wl_surface_commit(wl_data->surface);
+
+        // A full socket is flushed by the event loop, the present does not wait for the compositor
+        wl_display_flush(g_ctx->display);
+        buffer.presented = ++surface->presents;
+    }
+
+    static void destroy_software_surface(SoftwareSurface::Platform *pd)
+    {
+        auto *surface = (WaylandSoftwareSurface *)pd;
+        release_buffers(surface);
+        acul::release(surface);
+    }
+
+    void init_scall_data(LinuxSoftwareCaller &caller)
+    {
+        caller.create = create_software_surface;
+        caller.acquire = acquire_software_buffer;
+        caller.present = present_software_buffer;
+        caller.destroy = destroy_software_surface;
+    }
+} // namespace awin::platform::wayland
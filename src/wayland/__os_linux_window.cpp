@@ -46,7 +46,7 @@ namespace awin
             {
                 wl_data->hovered = true;
                 if (wl_data->cursor) assign_cursor(wl_data, get_cursor_pd(wl_data->cursor));
-                acul::events::dispatch_event_group<MouseEnterEvent>(g_env->events.mouse_enter, wl_data->owner, true);
+                input_mouse_enter(wl_data, true);
             }
             else if (wl_data->fallback.decorations)
                 wl_data->fallback.focus = surface;
@@ -67,7 +67,7 @@ namespace awin
             if (wl_data->hovered)
             {
                 wl_data->hovered = false;
-                acul::events::dispatch_event_group<MouseEnterEvent>(g_env->events.mouse_enter, wl_data->owner, false);
+                input_mouse_enter(wl_data, false);
             }
             else if (wl_data->fallback.decorations)
                 wl_data->fallback.focus = NULL;
@@ -77,6 +77,7 @@ namespace awin
         {
             auto *wl_data = g_ctx->pointer_focus;
             if (!wl_data) return;
+            EventTimeScope time_scope(time);
 
             wl_data->cursor_pos.x = wl_fixed_to_double(sx);
             wl_data->cursor_pos.y = wl_fixed_to_double(sy);
@@ -85,8 +86,7 @@ namespace awin
             if (wl_data->hovered)
             {
                 g_ctx->cursor_previous_name = NULL;
-                acul::events::dispatch_event_group<PosEvent>(g_env->events.mouse_move, event_id::mouse_move,
-                                                             wl_data->owner, cursor_pos);
+                input_cursor_pos(wl_data, cursor_pos);
                 return;
             }
 
@@ -156,13 +156,14 @@ namespace awin
         {
             auto *wl_data = g_ctx->pointer_focus;
             if (!wl_data) return;
+            EventTimeScope time_scope(time);
 
             if (wl_data->hovered)
             {
                 g_ctx->serial = serial;
-                acul::events::dispatch_event_group<MouseClickEvent>(
-                    g_env->events.mouse_click, wl_data->owner, static_cast<io::MouseKey>(button - BTN_LEFT),
-                    state == WL_POINTER_BUTTON_STATE_PRESSED ? io::KeyPressState::press : io::KeyPressState::release);
+                input_mouse_click(wl_data, static_cast<io::MouseKey>(button - BTN_LEFT),
+                                  state == WL_POINTER_BUTTON_STATE_PRESSED ? io::KeyPressState::press
+                                                                           : io::KeyPressState::release);
                 return;
             }
 
@@ -207,14 +208,13 @@ namespace awin
         {
             auto *window_data = g_ctx->pointer_focus;
             if (!window_data) return;
+            EventTimeScope time_scope(time);
 
             // NOTE: 10 units of motion per mouse wheel step seems to be a common ratio
             if (axis == WL_POINTER_AXIS_HORIZONTAL_SCROLL)
-                acul::events::dispatch_event_group<ScrollEvent>(g_env->events.scroll, window_data->owner,
-                                                                -wl_fixed_to_double(value) / 10.0, 0.0);
+                input_scroll(window_data, -wl_fixed_to_double(value) / 10.0, 0.0f);
             else if (axis == WL_POINTER_AXIS_VERTICAL_SCROLL)
-                acul::events::dispatch_event_group<ScrollEvent>(g_env->events.scroll, window_data->owner, 0.0,
-                                                                -wl_fixed_to_double(value) / 10.0);
+                input_scroll(window_data, 0.0f, -wl_fixed_to_double(value) / 10.0);
         }
 
         static const struct wl_pointer_listener pointer_listener = {
@@ -300,10 +300,9 @@ namespace awin
                                                    wl_fixed_t dx, wl_fixed_t dy, wl_fixed_t, wl_fixed_t)
         {
             WaylandWindowData *window = static_cast<WaylandWindowData *>(user_data);
-            acul::point2D<i32> delta = {static_cast<i32>(wl_fixed_to_double(dx)),
-                                        static_cast<i32>(wl_fixed_to_double(dy))};
-            acul::events::dispatch_event_group<PosEvent>(g_env->events.mouse_move_delta, event_id::mouse_move_delta,
-                                                         window->owner, delta);
+            // The timestamp has microsecond granularity, the other input events use milliseconds
+            EventTimeScope time_scope((u32)((((u64)time_hi << 32) | time_lo) / 1000));
+            input_cursor_delta(window, {wl_fixed_to_double(dx), wl_fixed_to_double(dy)});
         }
 
         static const struct zwp_relative_pointer_v1_listener relative_pointer_listener = {
@@ -319,7 +318,7 @@ namespace awin
         inline void mark_focus_window(WaylandWindowData *window)
         {
             window->focused = true;
-            acul::events::dispatch_event_group<FocusEvent>(g_env->events.focus, window->owner, true);
+            input_focus(window, true);
             if (!g_ctx->relative_pointer_manager || window->relative_pointer) return;
             window->relative_pointer =
                 zwp_relative_pointer_manager_v1_get_relative_pointer(g_ctx->relative_pointer_manager, g_ctx->pointer);
@@ -329,7 +328,7 @@ namespace awin
         inline void unmark_focus_window(WaylandWindowData *window)
         {
             window->focused = false;
-            acul::events::dispatch_event_group<FocusEvent>(g_env->events.focus, window->owner, false);
+            input_focus(window, false);
             if (!window->relative_pointer) return;
             zwp_relative_pointer_v1_destroy(window->relative_pointer);
             window->relative_pointer = nullptr;
@@ -389,8 +388,7 @@ namespace awin
                 const xkb_keysym_t keysym = compose_symbol(keysyms[0]);
                 const u32 codepoint = xkb_keysym_to_utf32(keysym);
                 if (codepoint != 0)
-                    acul::events::dispatch_event_group<CharInputEvent>(g_env->events.char_input, window_data->owner,
-                                                                       codepoint);
+                    dispatch_event<CharInputEvent>(g_env->events.char_input, window_data->owner, codepoint);
             }
         }
 
@@ -399,6 +397,7 @@ namespace awin
         {
             auto *window_data = g_ctx->keyboard_focus;
             if (!window_data) return;
+            EventTimeScope time_scope(time);
 
             const io::KeyPressState action =
                 state == WL_KEYBOARD_KEY_STATE_PRESSED ? io::KeyPressState::press : io::KeyPressState::release;
@@ -583,7 +582,7 @@ namespace awin
 
             window->scaling_numerator = numerator;
             const f32 dpi = numerator / 120.f;
-            acul::events::dispatch_event_group<DpiChangedEvent>(g_env->events.dpi_changed, window->owner, dpi, dpi);
+            dispatch_event<DpiChangedEvent>(g_env->events.dpi_changed, window->owner, dpi, dpi);
         }
 
         const struct wp_fractional_scale_v1_listener fractional_scale_listener = {
@@ -614,6 +613,9 @@ namespace awin
                     case XDG_TOPLEVEL_STATE_ACTIVATED:
                         window->pending.flags |= WindowFlagBits::activated;
                         break;
+                    case XDG_TOPLEVEL_STATE_RESIZING:
+                        window->pending.resizing = true;
+                        break;
                     default:
                         break;
                 }
@@ -692,16 +694,15 @@ namespace awin
             {
                 window->flags = is_pending_maximized ? (window->flags | WindowFlagBits::maximized)
                                                      : (window->flags & ~WindowFlagBits::maximized);
-                acul::events::dispatch_event_group<StateEvent>(g_env->events.maximize, event_id::maximize,
-                                                               window->owner, is_pending_maximized);
+                dispatch_event<StateEvent>(g_env->events.maximize, event_id::maximize, window->owner,
+                                           is_pending_maximized);
             }
             const bool is_pending_fullscreen = window->pending.flags & WindowFlagBits::fullscreen;
             window->flags = is_pending_fullscreen ? (window->flags | WindowFlagBits::fullscreen)
                                                   : (window->flags & ~WindowFlagBits::fullscreen);
 
-            if (resize_window(window, window->pending.dimensions))
-                acul::events::dispatch_event_group<PosEvent>(g_env->events.resize, event_id::resize, window->owner,
-                                                             window->pending.dimensions);
+            if (resize_window(window, window->pending.dimensions)) input_window_resize(window, window->dimenstions);
+            input_live_resize(window, window->pending.resizing);
         }
 
         static const struct xdg_surface_listener xdg_surface_listener = {xdg_surface_handle_configure};
@@ -739,8 +740,7 @@ namespace awin
             {
                 window->flags = maximized ? (window->flags | WindowFlagBits::maximized)
                                           : (window->flags & ~WindowFlagBits::maximized);
-                acul::events::dispatch_event_group<StateEvent>(g_env->events.maximize, event_id::maximize,
-                                                               window->owner, maximized);
+                dispatch_event<StateEvent>(g_env->events.maximize, event_id::maximize, window->owner, maximized);
             }
 
             window->flags = fullscreen ? (window->flags | WindowFlagBits::fullscreen)
@@ -748,9 +748,7 @@ namespace awin
 
             if (!(window->flags & WindowFlagBits::hidden)) window->flags &= ~WindowFlagBits::hidden;
 
-            if (resize_window(window, size))
-                acul::events::dispatch_event_group<PosEvent>(g_env->events.resize, event_id::resize, window->owner,
-                                                             window->dimenstions);
+            if (resize_window(window, size)) input_window_resize(window, window->dimenstions);
             wl_surface_commit(window->surface);
         }
 
@@ -853,7 +851,7 @@ namespace awin
         }
 
         static void create_fallback_edge(WaylandWindowData *window, FallbackEdgeWayland *edge, wl_surface *parent,
-                                         wl_buffer *buffer, acul::point2D<int> pos, acul::point2D<int> size)
+                                         ShmBuffer *buffer, acul::point2D<int> pos, acul::point2D<int> size)
         {
             edge->surface = wl_compositor_create_surface(g_ctx->compositor);
             wl_surface_set_user_data(edge->surface, window);
@@ -862,7 +860,7 @@ namespace awin
             wl_subsurface_set_position(edge->subsurface, pos.x, pos.y);
             edge->viewport = wp_viewporter_get_viewport(g_ctx->viewporter, edge->surface);
             wp_viewport_set_destination(edge->viewport, size.x, size.y);
-            wl_surface_attach(edge->surface, buffer, 0, 0);
+            attach_shm_buffer(edge->surface, buffer);
 
             wl_region *region = wl_compositor_create_region(g_ctx->compositor);
             wl_region_add(region, 0, 0, size.x, size.y);
@@ -871,78 +869,13 @@ namespace awin
             wl_region_destroy(region);
         }
 
-        static int create_tmpfile_cloexec(char *tmpname)
-        {
-            int fd;
-
-            fd = mkostemp(tmpname, O_CLOEXEC);
-            if (fd >= 0) unlink(tmpname);
-
-            return fd;
-        }
-
-        static int create_anonymous_file(off_t size)
-        {
-            static acul::string _template = "/awin-shared-XXXXXX";
-            const char *path;
-            int fd;
-            int ret;
-
-            fd = memfd_create("awin-shared", MFD_CLOEXEC | MFD_ALLOW_SEALING);
-            if (fd >= 0)
-                fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_SEAL);
-            else
-            {
-                path = getenv("XDG_RUNTIME_DIR");
-                if (!path)
-                {
-                    errno = ENOENT;
-                    return -1;
-                }
-
-                acul::string name{path};
-                name += _template;
-
-                fd = create_tmpfile_cloexec((char *)name.c_str());
-                if (fd < 0) return -1;
-            }
-
-            ret = posix_fallocate(fd, 0, size);
-            if (ret != 0)
-            {
-                close(fd);
-                errno = ret;
-                return -1;
-            }
-            return fd;
-        }
-
-        static wl_buffer *create_shm_buffer(const Image *image)
+        static ShmBuffer *create_shm_buffer(const Image *image)
         {
-            const int stride = image->dimenstions.x * 4;
-            const int length = image->dimenstions.x * image->dimenstions.y * 4;
-
-            const int fd = create_anonymous_file(length);
-            if (fd < 0)
-            {
-                AWIN_LOG_ERROR("Wayland: Failed to create buffer file of size %d: %s", length, strerror(errno));
-                return NULL;
-            }
-
-            void *data = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-            if (data == MAP_FAILED)
-            {
-                AWIN_LOG_ERROR("Wayland: Failed to map file: %s", strerror(errno));
-                close(fd);
-                return NULL;
-            }
-
-            struct wl_shm_pool *pool = wl_shm_create_pool(g_ctx->shm, fd, length);
-
-            close(fd);
+            ShmBuffer *buffer = acquire_shm_buffer(image->dimenstions);
+            if (!buffer) return NULL;
 
             unsigned char *source = (unsigned char *)image->pixels;
-            unsigned char *target = (unsigned char *)data;
+            unsigned char *target = get_shm_pixels(buffer);
             for (int i = 0; i < image->dimenstions.x * image->dimenstions.y; i++, source += 4)
             {
                 unsigned int alpha = source[3];
@@ -953,11 +886,6 @@ namespace awin
                 *target++ = (unsigned char)alpha;
             }
 
-            wl_buffer *buffer = wl_shm_pool_create_buffer(pool, 0, image->dimenstions.x, image->dimenstions.y, stride,
-                                                          WL_SHM_FORMAT_ARGB8888);
-            munmap(data, length);
-            wl_shm_pool_destroy(pool);
-
             return buffer;
         }
 
@@ -1032,14 +960,14 @@ namespace awin
 #ifdef AWIN_TEST_BUILD
                     if (g_ctx->is_surface_placeholder_enabled)
                     {
-                        static wl_buffer *stub = nullptr;
+                        ShmBuffer *&stub = g_ctx->surface_placeholder;
                         if (!stub)
                         {
                             unsigned char data[] = {0, 0, 0, 255};
                             const Image image = {{1, 1}, data};
                             stub = create_shm_buffer(&image);
                         }
-                        wl_surface_attach(wl_data->surface, stub, 0, 0);
+                        attach_shm_buffer(wl_data->surface, stub);
                         wl_surface_damage(wl_data->surface, 0, 0, 1, 1);
                         wl_surface_commit(wl_data->surface);
                     }
@@ -1198,24 +1126,38 @@ namespace awin
             if (wl_data->scaling_viewport) wp_viewport_destroy(wl_data->scaling_viewport);
             if (wl_data->idle_inhibitor) zwp_idle_inhibitor_v1_destroy(wl_data->idle_inhibitor);
             destroy_shell_objects(wl_data);
-            if (wl_data->fallback.buffer) wl_buffer_destroy(wl_data->fallback.buffer);
+            if (wl_data->fallback.buffer) release_shm_buffer(wl_data->fallback.buffer);
             AWIN_LOG_INFO("Wayland: Destroying window surface: %p", wl_data->surface);
             if (wl_data->surface) wl_surface_destroy(wl_data->surface);
             wl_data->output_scales.clear();
         }
 
-        static bool flush_display()
+        // Write out the queued requests without waiting. If the socket is full the rest stays buffered by
+        // libwayland and write_pending is set, the event loop then waits for POLLOUT and flushes again.
+        // Returns false if the connection failed.
+        static bool flush_display(bool &write_pending)
         {
-            while (wl_display_flush(g_ctx->display) == -1)
+            write_pending = false;
+            if (wl_display_flush(g_ctx->display) != -1) return true;
+            if (errno != EAGAIN) return false;
+            write_pending = true;
+            return true;
+        }
+
+        // Write out the queued requests, waiting for the socket to drain. Only for calls that wait for the
+        // compositor anyway.
+        static bool flush_display_blocking()
+        {
+            bool write_pending = true;
+            while (write_pending)
             {
-                if (errno != EAGAIN) return false;
+                if (!flush_display(write_pending)) return false;
+                if (!write_pending) break;
 
                 pollfd fd = {wl_display_get_fd(g_ctx->display), POLLOUT};
-
                 while (poll(&fd, 1, -1) == -1)
                     if (errno != EINTR && errno != EAGAIN) return false;
             }
-
             return true;
         }
 
@@ -1224,13 +1166,11 @@ namespace awin
             itimerspec timer = {{0}};
             auto *handle = wl_cursor->handle;
             wl_cursor_image *image;
-            wl_buffer *buffer;
+            wl_buffer *buffer = nullptr;
             wl_surface *surface = g_ctx->cursor_surface;
             int scale = 1;
 
-            if (!handle)
-                buffer = wl_cursor->buffer;
-            else
+            if (handle)
             {
                 if (wl_data->buffer_scale > 1) scale = 2;
 
@@ -1251,7 +1191,12 @@ namespace awin
             wl_pointer_set_cursor(g_ctx->pointer, g_ctx->pointer_enter_serial, surface, wl_cursor->hot.x / scale,
                                   wl_cursor->hot.y / scale);
             wl_surface_set_buffer_scale(surface, scale);
-            wl_surface_attach(surface, buffer, 0, 0);
+            // Custom cursor images stay busy until the compositor releases them, so a destroyed cursor does not hand
+            // its range back to the pool while it is still shown
+            if (!handle)
+                attach_shm_buffer(surface, wl_cursor->buffer);
+            else
+                wl_surface_attach(surface, buffer, 0, 0);
             wl_surface_damage(surface, 0, 0, wl_cursor->size.x, wl_cursor->size.y);
             wl_surface_commit(surface);
         }
@@ -1271,6 +1216,20 @@ namespace awin
             }
         }
 
+        // Dispatch the events already read from the connection, the input queue ahead of the default queue.
+        // Returns the number of dispatched events or -1 on failure.
+        static int dispatch_pending_queues()
+        {
+            int count = 0;
+            if (g_ctx->input_queue)
+            {
+                count = wl_display_dispatch_queue_pending(g_ctx->display, g_ctx->input_queue);
+                if (count < 0) return count;
+            }
+            const int rest = wl_display_dispatch_pending(g_ctx->display);
+            return rest < 0 ? rest : count + rest;
+        }
+
         static void handle_events(f64 *timeout)
         {
             bool event = false;
@@ -1279,23 +1238,28 @@ namespace awin
                 DISPLAY_FD,
                 KEYREPEAT_FD,
                 CURSOR_FD,
+                WAKE_FD,
                 LIBDECOR_FD
             };
             pollfd fds[] = {{wl_display_get_fd(g_ctx->display), POLLIN},
                             {g_ctx->key_repeat_timer_fd, POLLIN},
                             {g_ctx->cursor_timer_fd, POLLIN},
+                            {g_env->wake.fd, POLLIN},
                             {-1, POLLIN}};
 
             if (g_ctx->libdecor.context) fds[LIBDECOR_FD].fd = libdecor_get_fd(g_ctx->libdecor.context);
 
             while (!event)
             {
+                // Preparing the read only checks the default queue, input left from an earlier read goes first
+                if (dispatch_pending_queues() > 0) return;
                 while (wl_display_prepare_read(g_ctx->display) != 0)
-                    if (wl_display_dispatch_pending(g_ctx->display) > 0) return;
+                    if (dispatch_pending_queues() > 0) return;
 
                 // If an error other than EAGAIN happens, we have likely been disconnected
                 // from the Wayland session; try to handle that the best we can.
-                if (!flush_display())
+                bool write_pending;
+                if (!flush_display(write_pending))
                 {
                     wl_display_cancel_read(g_ctx->display);
 
@@ -1304,16 +1268,22 @@ namespace awin
                     return;
                 }
 
-                if (!poll_posix(fds, sizeof(fds) / sizeof(fds[0]), timeout))
+                // A full socket is drained by the next iterations instead of blocking here, so poll_events never
+                // waits for a stalled compositor
+                fds[DISPLAY_FD].events = write_pending ? POLLIN | POLLOUT : POLLIN;
+
+                bool watched;
+                if (!poll_watched(fds, sizeof(fds) / sizeof(fds[0]), timeout, watched))
                 {
                     wl_display_cancel_read(g_ctx->display);
                     return;
                 }
+                if (watched) event = true;
 
                 if (fds[DISPLAY_FD].revents & POLLIN)
                 {
                     wl_display_read_events(g_ctx->display);
-                    if (wl_display_dispatch_pending(g_ctx->display) > 0) event = true;
+                    if (dispatch_pending_queues() > 0) event = true;
                 }
                 else
                     wl_display_cancel_read(g_ctx->display);
@@ -1344,6 +1314,12 @@ namespace awin
                     if (read(g_ctx->cursor_timer_fd, &repeats, sizeof(repeats)) == 8)
                         increment_cursor_image(g_ctx->pointer_focus);
                 }
+
+                if (fds[WAKE_FD].revents & POLLIN)
+                {
+                    drain_wake_event(g_env->wake);
+                    event = true;
+                }
             }
 
             if (fds[LIBDECOR_FD].revents & POLLIN)
@@ -1360,12 +1336,15 @@ namespace awin
 
         void wait_events() { handle_events(NULL); }
 
-        void wait_events_timeout() { handle_events(g_env->timeout > WINDOW_TIMEOUT_INF ? &g_env->timeout : NULL); }
+        void wait_events_timeout(f64 timeout) { handle_events(&timeout); }
 
-        void push_empty_event()
+        void get_event_fds(acul::vector<int> &fds)
         {
-            wl_display_sync(g_ctx->display);
-            flush_display();
+            fds.push_back(wl_display_get_fd(g_ctx->display));
+            fds.push_back(g_ctx->key_repeat_timer_fd);
+            fds.push_back(g_ctx->cursor_timer_fd);
+            fds.push_back(g_env->wake.fd);
+            if (g_ctx->libdecor.context) fds.push_back(libdecor_get_fd(g_ctx->libdecor.context));
         }
 
         f32 get_dpi(WindowData *window_data)
@@ -1444,7 +1423,7 @@ namespace awin
             }
 
             wl_data_offer_receive(offer, mime_type, fds[1]);
-            flush_display();
+            flush_display_blocking();
             close(fds[1]);
 
             acul::string r;
@@ -1630,7 +1609,7 @@ namespace awin
         {
             auto *wl_cursor = (WaylandCursor *)pd;
             if (wl_cursor->handle) return;
-            if (wl_cursor->buffer) wl_buffer_destroy(wl_cursor->buffer);
+            if (wl_cursor->buffer) release_shm_buffer(wl_cursor->buffer);
         }
 
         bool is_cursor_valid(const Cursor::Platform *pd)
@@ -16,6 +16,10 @@ typedef void (*PFN_wl_display_disconnect)(struct wl_display *);
 typedef int (*PFN_wl_display_roundtrip)(struct wl_display *);
 typedef int (*PFN_wl_display_get_fd)(struct wl_display *);
 typedef int (*PFN_wl_display_prepare_read)(struct wl_display *);
+typedef struct wl_event_queue *(*PFN_wl_display_create_queue)(struct wl_display *);
+typedef int (*PFN_wl_display_dispatch_queue_pending)(struct wl_display *, struct wl_event_queue *);
+typedef void (*PFN_wl_event_queue_destroy)(struct wl_event_queue *);
+typedef void (*PFN_wl_proxy_set_queue)(struct wl_proxy *, struct wl_event_queue *);
 typedef void (*PFN_wl_proxy_marshal)(struct wl_proxy *, u32, ...);
 typedef int (*PFN_wl_proxy_add_listener)(struct wl_proxy *, void (**)(void), void *);
 typedef void (*PFN_wl_proxy_destroy)(struct wl_proxy *);
@@ -205,6 +209,10 @@ namespace awin
                 PFN_wl_display_roundtrip wl_display_roundtrip;
                 PFN_wl_display_get_fd wl_display_get_fd;
                 PFN_wl_display_prepare_read wl_display_prepare_read;
+                PFN_wl_display_create_queue wl_display_create_queue;
+                PFN_wl_display_dispatch_queue_pending wl_display_dispatch_queue_pending;
+                PFN_wl_event_queue_destroy wl_event_queue_destroy;
+                PFN_wl_proxy_set_queue wl_proxy_set_queue;
                 PFN_wl_proxy_marshal wl_proxy_marshal;
                 PFN_wl_proxy_add_listener wl_proxy_add_listener;
                 PFN_wl_proxy_destroy wl_proxy_destroy;
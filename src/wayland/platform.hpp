@@ -16,6 +16,11 @@
 #define wl_display_roundtrip         awin::platform::wayland::g_ctx->wl.client.wl_display_roundtrip
 #define wl_display_get_fd            awin::platform::wayland::g_ctx->wl.client.wl_display_get_fd
 #define wl_display_prepare_read      awin::platform::wayland::g_ctx->wl.client.wl_display_prepare_read
+#define wl_display_create_queue      awin::platform::wayland::g_ctx->wl.client.wl_display_create_queue
+#define wl_display_dispatch_queue_pending \
+    awin::platform::wayland::g_ctx->wl.client.wl_display_dispatch_queue_pending
+#define wl_event_queue_destroy       awin::platform::wayland::g_ctx->wl.client.wl_event_queue_destroy
+#define wl_proxy_set_queue           awin::platform::wayland::g_ctx->wl.client.wl_proxy_set_queue
 #define wl_proxy_marshal             awin::platform::wayland::g_ctx->wl.client.wl_proxy_marshal
 #define wl_proxy_add_listener        awin::platform::wayland::g_ctx->wl.client.wl_proxy_add_listener
 #define wl_proxy_destroy             awin::platform::wayland::g_ctx->wl.client.wl_proxy_destroy
@@ -62,6 +67,7 @@ struct wl_registry;
 struct wl_compositor;
 struct wl_subcompositor;
 struct wl_shm;
+struct wl_shm_pool;
 struct wl_seat;
 struct wl_pointer;
 struct wl_keyboard;
@@ -296,11 +302,49 @@ namespace awin::platform::wayland
         }
     };
 
+    // A buffer sub-allocated from the shared memory pool. The pixels are ARGB8888 with a stride of 4 * width.
+    struct ShmBuffer
+    {
+        wl_buffer *handle;
+        i32 offset, size; // Byte range in the pool file, the size is rounded up to the alignment of the pool
+        acul::point2D<i32> dimensions;
+        bool busy;     // Attached and not yet released by the compositor
+        bool returned; // Given back by its owner, reused once the compositor released it
+    };
+
+    struct ShmMapping
+    {
+        u8 *data;
+        i32 size;
+    };
+
+    struct ShmRange
+    {
+        i32 offset, size;
+    };
+
+    // Shared memory file all shm buffers of the connection are sub-allocated from. A returned buffer of the same
+    // size is handed out again as is, the other returned buffers released by the compositor are destroyed and their
+    // ranges merged into the free list. The file grows with wl_shm_pool_resize when no free range fits.
+    struct ShmPool
+    {
+        wl_shm_pool *handle;
+        int fd;
+        u8 *data;
+        i32 capacity, used; // Bytes past 'used' are free, a freed range at the end moves it back
+        acul::vector<ShmBuffer *> buffers;
+        acul::vector<ShmRange> free;      // Free ranges below 'used', sorted by offset and never adjacent
+        acul::vector<ShmMapping> retired; // Mappings replaced by a growth, kept for the pixels handed out before
+    };
+
     extern APPLIB_API struct Context
     {
         WaylandLoader wl;
 
         wl_display *display;
+        // Queue of the seat, pointer and keyboard events. It is dispatched ahead of the default queue so input does
+        // not wait behind configure, output and clipboard handling. Null if libwayland-client lacks queue support.
+        wl_event_queue *input_queue;
         wl_registry *registry;
         wl_compositor *compositor;
         wl_subcompositor *subcompositor;
@@ -330,6 +374,7 @@ namespace awin::platform::wayland
         int cursor_timer_fd;
         acul::vector<Output> outputs;
         acul::vector<Offer> offers;
+        ShmPool shm_pool;
         wl_data_offer *selection_offer;
         wl_data_source *selection_source;
 
@@ -359,23 +404,43 @@ namespace awin::platform::wayland
         acul::lut_table<256, KeyTraits> keymap;
 #ifdef AWIN_TEST_BUILD
         bool is_surface_placeholder_enabled = false;
+        ShmBuffer *surface_placeholder = nullptr; // Shared by all windows, owned by the shm pool
 #endif
     } *g_ctx;
 
     struct WaylandCursor : Cursor::Platform
     {
         wl_cursor *handle;
-        wl_buffer *buffer;
+        ShmBuffer *buffer;
         acul::point2D<int> size, hot;
         int current_image;
     };
 
+    // Get a buffer of the given size from the shared memory pool. A growth of the pool moves the current mapping, so
+    // get_shm_pixels may return a new address afterwards. Addresses taken before stay valid until the pool is
+    // destroyed, the old mappings are kept until then.
+    ShmBuffer *acquire_shm_buffer(acul::point2D<i32> dimensions);
+
+    // Pixels of the buffer in the current client mapping of the pool
+    inline u8 *get_shm_pixels(const ShmBuffer *buffer) { return g_ctx->shm_pool.data + buffer->offset; }
+
+    // Attach the buffer to the surface and keep it from being reused until the compositor releases it
+    void attach_shm_buffer(wl_surface *surface, ShmBuffer *buffer);
+
+    // Give the buffer back to the pool. Once the compositor is done with it, it is reused for a request of the same
+    // size or destroyed and its range freed by the next request of another size.
+    void release_shm_buffer(ShmBuffer *buffer);
+
+    // Destroy the pool and all of its buffers
+    void destroy_shm_pool();
+
     void add_seat_listener(wl_seat *seat);
     void add_data_device_listener(wl_data_device *device);
 
     void init_pcall_data(LinuxPlatformCaller &caller);
     void init_wcall_data(LinuxWindowCaller &caller);
     void init_ccall_data(LinuxCursorCaller &caller);
+    void init_scall_data(LinuxSoftwareCaller &caller);
 
     Cursor::Platform *create_cursor(Cursor::Type);
     void assign_cursor(Window *, Cursor::Platform *);
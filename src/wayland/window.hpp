@@ -37,7 +37,7 @@ namespace awin
                 struct
                 {
                     bool decorations;
-                    wl_buffer *buffer;
+                    ShmBuffer *buffer;
                     FallbackEdgeWayland top, left, right, bottom;
                     wl_surface *focus;
                 } fallback;
@@ -52,6 +52,7 @@ namespace awin
                 {
                     acul::point2D<int> dimensions;
                     WindowFlags flags;
+                    bool resizing;
                 } pending;
             };
 
@@ -78,8 +79,8 @@ namespace awin
 
             void poll_events();
             void wait_events();
-            void wait_events_timeout();
-            void push_empty_event();
+            void wait_events_timeout(f64 timeout);
+            void get_event_fds(acul::vector<int> &fds);
 
             acul::point2D<i32> get_window_position(WindowData *window);
             void set_window_position(WindowData *window, acul::point2D<i32> position);
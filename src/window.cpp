@@ -1,6 +1,12 @@
+#include <algorithm>
 #include <awin/window.hpp>
 #include <cmath>
+#include <iterator>
+#include <tuple>
 #include "env.hpp"
+#ifndef _WIN32
+    #include "event_thread.hpp"
+#endif
 
 namespace awin
 {
@@ -19,10 +25,450 @@ namespace awin
                 if (repeated) action = io::KeyPressState::repeat;
             }
 
-            acul::events::dispatch_event_group<KeyInputEvent>(g_env->events.key_input, data->owner, key, action, mods);
+            flush_cursor_pos(data);
+            dispatch_event<KeyInputEvent>(g_env->events.key_input, data->owner, key, action, mods);
+        }
+
+        inline void queue_deferred(WindowData *data)
+        {
+            if (data->deferred.queued) return;
+            data->deferred.queued = true;
+            g_env->deferred.push_back(data);
+        }
+
+        void input_cursor_pos(WindowData *data, acul::point2D<i32> position)
+        {
+            if (g_env->coalescing & CoalesceBits::mouse_move)
+            {
+                data->deferred.cursor_pos = position;
+                data->deferred.motion_time = g_env->server_time;
+                ++data->deferred.motion_count;
+                queue_deferred(data);
+                return;
+            }
+            dispatch_event<PosEvent>(g_env->events.mouse_move, event_id::mouse_move, data->owner, position);
+        }
+
+        static void dispatch_cursor_delta(WindowData *data, acul::point2D<f64> delta, u32 count)
+        {
+            auto &rest = data->deferred.delta_remainder;
+            const acul::point2D<f64> total{delta.x + rest.x, delta.y + rest.y};
+            const acul::point2D<i32> steps{static_cast<i32>(std::trunc(total.x)),
+                                           static_cast<i32>(std::trunc(total.y))};
+            rest = {total.x - steps.x, total.y - steps.y};
+            dispatch_event<DeltaEvent>(g_env->events.mouse_move_delta, data->owner, delta, steps, count);
+        }
+
+        void input_cursor_delta(WindowData *data, acul::point2D<f64> delta)
+        {
+            if (g_env->coalescing & CoalesceBits::mouse_move_delta)
+            {
+                data->deferred.delta.x += delta.x;
+                data->deferred.delta.y += delta.y;
+                data->deferred.delta_time = g_env->server_time;
+                ++data->deferred.delta_count;
+                queue_deferred(data);
+                return;
+            }
+            dispatch_cursor_delta(data, delta, 1);
+        }
+
+        void input_mouse_click(WindowData *data, io::MouseKey button, io::KeyPressState action, io::KeyMode mods)
+        {
+            flush_cursor_pos(data);
+            dispatch_event<MouseClickEvent>(g_env->events.mouse_click, data->owner, button, action, mods);
+        }
+
+        void input_scroll(WindowData *data, f32 h, f32 v)
+        {
+            flush_cursor_pos(data);
+            dispatch_event<ScrollEvent>(g_env->events.scroll, data->owner, h, v);
+        }
+
+        void input_mouse_enter(WindowData *data, bool entered)
+        {
+            flush_cursor_pos(data);
+            dispatch_event<MouseEnterEvent>(g_env->events.mouse_enter, data->owner, entered);
+        }
+
+        void input_focus(WindowData *data, bool focused)
+        {
+            flush_cursor_pos(data);
+            dispatch_event<FocusEvent>(g_env->events.focus, data->owner, focused);
+        }
+
+        void input_window_resize(WindowData *data, acul::point2D<i32> size)
+        {
+            if (g_env->coalescing & CoalesceBits::resize)
+            {
+                data->deferred.size = size;
+                data->deferred.resize_time = g_env->server_time;
+                data->deferred.resize_pending = true;
+                queue_deferred(data);
+                return;
+            }
+            dispatch_event<PosEvent>(g_env->events.resize, event_id::resize, data->owner, size);
+        }
+
+        void input_live_resize(WindowData *data, bool active)
+        {
+            if (data->live_resize == active) return;
+            data->live_resize = active;
+            if (!active) flush_window_resize(data);
+            dispatch_event<StateEvent>(g_env->events.live_resize, event_id::live_resize, data->owner, active);
+        }
+
+        void flush_window_resize(WindowData *data)
+        {
+            if (!data->deferred.resize_pending) return;
+            data->deferred.resize_pending = false;
+            EventTimeScope time_scope(data->deferred.resize_time);
+            dispatch_event<PosEvent>(g_env->events.resize, event_id::resize, data->owner, data->deferred.size);
+        }
+
+        void flush_cursor_pos(WindowData *data)
+        {
+            const u32 count = data->deferred.motion_count;
+            if (count == 0) return;
+            data->deferred.motion_count = 0;
+            EventTimeScope time_scope(data->deferred.motion_time);
+            dispatch_event<PosEvent>(g_env->events.mouse_move, event_id::mouse_move, data->owner,
+                                     data->deferred.cursor_pos, count);
+        }
+
+        void flush_cursor_delta(WindowData *data)
+        {
+            const u32 count = data->deferred.delta_count;
+            if (count == 0) return;
+            const acul::point2D<f64> delta = data->deferred.delta;
+            data->deferred.delta = {0.0, 0.0};
+            data->deferred.delta_count = 0;
+            EventTimeScope time_scope(data->deferred.delta_time);
+            dispatch_cursor_delta(data, delta, count);
+        }
+
+        void flush_deferred_events()
+        {
+            // Listeners may destroy windows or queue new events, so the list is walked by index
+            for (size_t i = 0; i < g_env->deferred.size(); ++i)
+            {
+                WindowData *data = g_env->deferred[i];
+                if (!data) continue;
+                data->deferred.queued = false;
+                flush_window_resize(data);
+                flush_cursor_delta(data);
+                flush_cursor_pos(data);
+            }
+            g_env->deferred.clear();
+        }
+
+        // Marks the window for publishing its input snapshot at the end of the poll cycle
+        static void queue_input(WindowData *data)
+        {
+            if (data->input_queued) return;
+            data->input_queued = true;
+            g_env->input_windows.push_back(data);
+        }
+
+        void track_input(const acul::events::event &event)
+        {
+            switch (event.id)
+            {
+                case event_id::key_input:
+                {
+                    const auto &key_event = static_cast<const KeyInputEvent &>(event);
+                    if (!key_event.window) return;
+                    auto *data = get_window_data(*key_event.window);
+                    const io::Key key = key_event.key;
+                    if (+key >= 0 && key <= io::Key::last)
+                    {
+                        auto &input = data->input;
+                        const size_t word = key >> 6;
+                        const u64 bit = u64(1) << (key & 63);
+                        switch (key_event.action)
+                        {
+                            case io::KeyPressState::press:
+                                input.keys_down[word] |= bit;
+                                input.keys_pressed[word] |= bit;
+                                break;
+                            case io::KeyPressState::release:
+                                input.keys_down[word] &= ~bit;
+                                input.keys_released[word] |= bit;
+                                break;
+                            default:
+                                input.keys_repeated[word] |= bit;
+                                break;
+                        }
+                    }
+                    data->input.mods = key_event.mods;
+                    queue_input(data);
+                    break;
+                }
+                case event_id::mouse_click:
+                {
+                    const auto &click = static_cast<const MouseClickEvent &>(event);
+                    if (!click.window) return;
+                    auto *data = get_window_data(*click.window);
+                    if (click.button != io::MouseKey::unknown)
+                    {
+                        const u8 bit = 1 << +click.button;
+                        if (click.action == io::KeyPressState::release)
+                        {
+                            data->input.buttons_down &= ~bit;
+                            data->input.buttons_released |= bit;
+                        }
+                        else
+                        {
+                            data->input.buttons_down |= bit;
+                            data->input.buttons_pressed |= bit;
+                        }
+                    }
+                    data->input.mods = click.mods;
+                    queue_input(data);
+                    break;
+                }
+                case event_id::mouse_move:
+                {
+                    const auto &motion = static_cast<const PosEvent &>(event);
+                    if (!motion.window) return;
+                    auto *data = get_window_data(*motion.window);
+                    data->input.cursor_pos = motion.position;
+                    queue_input(data);
+                    break;
+                }
+                case event_id::scroll:
+                {
+                    const auto &scroll = static_cast<const ScrollEvent &>(event);
+                    if (!scroll.window) return;
+                    auto *data = get_window_data(*scroll.window);
+                    data->input.scroll.x += scroll.h;
+                    data->input.scroll.y += scroll.v;
+                    queue_input(data);
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+
+        template <typename T>
+        static bool deliver_batch(EventBatchQueue<T> &queue)
+        {
+            if (queue.events.empty()) return false;
+
+            // Listeners may queue new events, which are delivered on the next pass. Events of a window destroyed by a
+            // listener lose their window and are skipped.
+            std::swap(queue.events, queue.delivering);
+            auto &events = queue.delivering;
+            if (queue.group)
+                for (auto &event : events)
+                    for (const auto &node : *queue.group)
+                    {
+                        if (!event.window) break;
+                        node.call(node.ctx, event);
+                    }
+            events.erase(std::remove_if(events.begin(), events.end(), [](const T &event) { return !event.window; }),
+                         events.end());
+            if (g_env->events.batch && !events.empty())
+            {
+                EventBatch batch(events.front().id, events.data(), events.size());
+                for (const auto &node : *g_env->events.batch) node.call(node.ctx, batch);
+            }
+            events.clear();
+            return true;
+        }
+
+        void deliver_batched_events()
+        {
+            bool delivered = true;
+            while (delivered)
+            {
+                delivered = false;
+                std::apply([&](auto &...queue) { ((delivered |= deliver_batch(queue)), ...); }, g_env->batches);
+            }
+        }
+
+        void publish_input_snapshots()
+        {
+            auto &windows = g_env->input_windows;
+            size_t kept = 0;
+            for (WindowData *data : windows)
+            {
+                if (!data) continue;
+                auto &input = data->input;
+                const bool changed = InputSnapshot::any(input.keys_pressed) ||
+                                     InputSnapshot::any(input.keys_released) ||
+                                     InputSnapshot::any(input.keys_repeated) || input.buttons_pressed ||
+                                     input.buttons_released || input.scroll.x != 0.0f || input.scroll.y != 0.0f;
+                data->snapshot = input;
+                std::fill(std::begin(input.keys_pressed), std::end(input.keys_pressed), 0);
+                std::fill(std::begin(input.keys_released), std::end(input.keys_released), 0);
+                std::fill(std::begin(input.keys_repeated), std::end(input.keys_repeated), 0);
+                input.buttons_pressed = input.buttons_released = 0;
+                input.scroll = {0.0f, 0.0f};
+
+                // Windows with per-cycle changes are kept for one more cycle so that their snapshot gets cleared
+                if (changed)
+                    windows[kept++] = data;
+                else
+                    data->input_queued = false;
+            }
+            windows.resize(kept);
+        }
+
+        void discard_deferred_events(WindowData *data)
+        {
+            data->deferred.motion_count = 0;
+            data->deferred.delta = {0.0, 0.0};
+            data->deferred.delta_count = 0;
+            data->deferred.resize_pending = false;
+            if (!data->deferred.queued) return;
+            data->deferred.queued = false;
+            auto it = std::find(g_env->deferred.begin(), g_env->deferred.end(), data);
+            if (it != g_env->deferred.end()) *it = nullptr;
+        }
+
+        void discard_queued_events(WindowData *data)
+        {
+            std::apply(
+                [data](auto &...queue) {
+                    auto remove = [data](auto &events) {
+                        auto it = std::remove_if(events.begin(), events.end(),
+                                                 [data](const auto &event) { return event.window == data->owner; });
+                        events.erase(it, events.end());
+                    };
+                    // The list being delivered is walked by the delivery loop, its entries are only detached
+                    auto detach = [data](auto &events) {
+                        for (auto &event : events)
+                            if (event.window == data->owner) event.window = nullptr;
+                    };
+                    (remove(queue.events), ...);
+                    (detach(queue.delivering), ...);
+                },
+                g_env->batches);
+            if (data->input_queued)
+            {
+                data->input_queued = false;
+                auto it = std::find(g_env->input_windows.begin(), g_env->input_windows.end(), data);
+                if (it != g_env->input_windows.end()) *it = nullptr;
+            }
+        }
+
+        f64 next_timer_deadline()
+        {
+            f64 deadline = INFINITY;
+            for (const Timer *timer : g_env->timers) deadline = std::min(deadline, timer->deadline());
+            return deadline;
+        }
+
+        acul::events::event_group *get_event_group(u64 id)
+        {
+            auto &events = g_env->events;
+            switch (id)
+            {
+                case event_id::focus:
+                    return events.focus;
+                case event_id::char_input:
+                    return events.char_input;
+                case event_id::key_input:
+                    return events.key_input;
+                case event_id::mouse_click:
+                    return events.mouse_click;
+                case event_id::mouse_enter:
+                    return events.mouse_enter;
+                case event_id::mouse_move_delta:
+                    return events.mouse_move_delta;
+                case event_id::mouse_move:
+                    return events.mouse_move;
+                case event_id::scroll:
+                    return events.scroll;
+                case event_id::minimize:
+                    return events.minimize;
+                case event_id::maximize:
+                    return events.maximize;
+                case event_id::resize:
+                    return events.resize;
+                case event_id::move:
+                    return events.move;
+                case event_id::live_resize:
+                    return events.live_resize;
+                case event_id::dpi_changed:
+                    return events.dpi_changed;
+                default:
+                    return nullptr;
+            }
+        }
+
+        // The state seen by the calling thread: the copy published to the polling thread when an event thread is used
+        static WindowState get_window_state(const WindowData *data)
+        {
+#ifndef _WIN32
+            if (g_env->event_thread && !is_event_thread()) return data->state;
+#endif
+            return capture_window_state(data);
+        }
+
+        // Apply a change made through the setters of Window where the backend reads it
+        template <typename F>
+        static void post_window_change(F fn)
+        {
+#ifndef _WIN32
+            post_command(std::move(fn));
+#else
+            fn();
+#endif
         }
     } // namespace platform
 
+    acul::point2D<i32> Window::dimensions() const { return platform::get_window_state(_data).dimensions; }
+
+    bool Window::decorated() const
+    {
+        return (platform::get_window_state(_data).flags & WindowFlagBits::decorated) != 0;
+    }
+
+    bool Window::resizable() const
+    {
+        return (platform::get_window_state(_data).flags & WindowFlagBits::resizable) != 0;
+    }
+
+    bool Window::fullscreen() const
+    {
+        return (platform::get_window_state(_data).flags & WindowFlagBits::fullscreen) != 0;
+    }
+
+    bool Window::is_cursor_hidden() const { return platform::get_window_state(_data).is_cursor_hidden; }
+
+    void Window::set_cursor(Cursor *cursor)
+    {
+        platform::post_window_change([data = _data, cursor] { data->cursor = cursor; });
+    }
+
+    bool Window::focused() const { return platform::get_window_state(_data).focused; }
+
+    bool Window::minimized() const { return platform::get_window_state(_data).flags & WindowFlagBits::minimized; }
+
+    bool Window::maximized() const { return platform::get_window_state(_data).flags & WindowFlagBits::maximized; }
+
+    bool Window::hidden() const { return platform::get_window_state(_data).flags & WindowFlagBits::hidden; }
+
+    acul::point2D<i32> Window::resize_limit() const { return platform::get_window_state(_data).resize_limit; }
+
+    void Window::resize_limit(acul::point2D<i32> size)
+    {
+        _data->state.resize_limit = size;
+        platform::post_window_change([data = _data, size] { data->resize_limit = size; });
+        update_resize_limit();
+    }
+
+    bool Window::ready_to_close() const { return platform::get_window_state(_data).ready_to_close; }
+
+    void Window::ready_to_close(bool ready_to_close)
+    {
+        _data->state.ready_to_close = ready_to_close;
+        platform::post_window_change([data = _data, ready_to_close] { data->ready_to_close = ready_to_close; });
+    }
+
     Cursor &Cursor::operator=(Cursor &&other) noexcept
     {
         if (this != &other)
@@ -35,6 +481,33 @@ namespace awin
         return *this;
     }
 
+    void set_event_coalescing(CoalesceFlags flags)
+    {
+        assert(platform::g_env);
+#ifdef _WIN32
+        platform::g_env->coalescing = flags;
+        platform::flush_deferred_events();
+#else
+        platform::run_command([flags] {
+            platform::g_env->coalescing = flags;
+            platform::flush_deferred_events();
+        });
+#endif
+    }
+
+    CoalesceFlags get_event_coalescing() { return platform::g_env->coalescing; }
+
+    void set_event_batching(bool enabled)
+    {
+        assert(platform::g_env);
+        platform::g_env->batching = enabled;
+        if (!enabled) platform::deliver_batched_events();
+    }
+
+    bool get_event_batching() { return platform::g_env->batching; }
+
+    const InputSnapshot &get_input_snapshot(const Window &window) { return get_window_data(window)->snapshot; }
+
     void update_events()
     {
         using namespace platform;
@@ -52,6 +525,7 @@ namespace awin
         acul::events::cache_event_group(event_id::maximize, events.maximize, ed);
         acul::events::cache_event_group(event_id::resize, events.resize, ed);
         acul::events::cache_event_group(event_id::move, events.move, ed);
+        acul::events::cache_event_group(event_id::live_resize, events.live_resize, ed);
         acul::events::cache_event_group(event_id::char_input, events.char_input, ed);
         acul::events::cache_event_group(event_id::key_input, events.key_input, ed);
         acul::events::cache_event_group(event_id::mouse_click, events.mouse_click, ed);
@@ -59,6 +533,7 @@ namespace awin
         acul::events::cache_event_group(event_id::mouse_move_delta, events.mouse_move_delta, ed);
         acul::events::cache_event_group(event_id::mouse_move, events.mouse_move, ed);
         acul::events::cache_event_group(event_id::dpi_changed, events.dpi_changed, ed);
+        acul::events::cache_event_group(event_id::batch, events.batch, ed);
     }
 
     void init_library(const InitConfig &config)
@@ -66,29 +541,118 @@ namespace awin
         platform::g_env = acul::alloc<platform::WindowEnvironment>();
         platform::g_env->log_service = config.log_service;
         platform::g_env->logger = config.logger;
+        platform::g_env->backend = config.backend;
+#ifndef _WIN32
+        platform::g_env->xcb_events = config.xcb_events;
+#endif
         if (!platform::init_platform()) throw acul::runtime_error("Failed to initialize Window platform");
         platform::init_timer();
+        auto &timer = platform::g_env->timer;
+        timer.seconds_per_tick = 1.0 / static_cast<f64>(timer.frequency);
+        timer.ns_per_tick = 1'000'000'000 % timer.frequency == 0 ? 1'000'000'000 / timer.frequency : 0;
         set_time(0.0);
         platform::g_env->ed = config.events_dispatcher;
         platform::g_env->default_cursor = Cursor::create(Cursor::Type::arrow);
+#ifndef _WIN32
+        if (config.event_thread && !platform::start_event_thread())
+            throw acul::runtime_error("Failed to start the event thread");
+#endif
     }
 
     void destroy_library()
     {
         assert(platform::g_env);
         AWIN_LOG_INFO("Destroying Window library");
+#ifndef _WIN32
+        platform::stop_event_thread();
+#endif
         platform::g_env->default_cursor.reset();
         platform::destroy_platform();
         acul::release(platform::g_env);
         platform::g_env = nullptr;
     }
 
+    void Timer::start(f64 delay, f64 interval)
+    {
+        if (!_active) platform::g_env->timers.push_back(this);
+        _deadline = get_time() + std::max(delay, 0.0);
+        _interval = interval;
+        _active = true;
+        platform::update_timers();
+    }
+
+    void Timer::start_once(f64 delay) { start(delay, 0.0); }
+
+    void Timer::start_periodic(f64 interval)
+    {
+        if (!(interval > 0.0))
+        {
+            AWIN_LOG_ERROR("Invalid timer interval: %f", interval);
+            return;
+        }
+        start(interval, interval);
+    }
+
+    void Timer::stop()
+    {
+        if (!_active || !platform::g_env) return;
+        auto &timers = platform::g_env->timers;
+        timers.erase(std::find(timers.begin(), timers.end(), this));
+        _active = false;
+        platform::update_timers();
+    }
+
+    void fire_timers()
+    {
+        auto &timers = platform::g_env->timers;
+        if (timers.empty()) return;
+        const f64 now = get_time();
+        const u64 cycle = ++platform::g_env->timer_cycle;
+
+        // Callbacks may start, stop or destroy timers, so the list is searched again after each of them
+        for (size_t i = 0; i < timers.size();)
+        {
+            Timer *timer = timers[i];
+            if (timer->_deadline > now || timer->_cycle == cycle)
+            {
+                ++i;
+                continue;
+            }
+            timer->_cycle = cycle;
+            if (timer->_interval > 0.0)
+            {
+                const f64 periods = std::floor((now - timer->_deadline) / timer->_interval) + 1.0;
+                timer->_deadline += periods * timer->_interval;
+            }
+            else
+            {
+                timers.erase(timers.begin() + i);
+                timer->_active = false;
+            }
+            timer->_callback(*timer, timer->_user_data);
+            i = 0;
+        }
+
+        // Rearmed even when nothing fired, a descriptor that expired before any timer was due stays disarmed otherwise
+        platform::update_timers();
+    }
+
+#ifndef __linux__
     f64 get_time()
     {
-        return static_cast<f64>(platform::get_time_value() - platform::g_env->timer.offset) /
-               platform::get_time_frequency();
+        const auto &timer = platform::g_env->timer;
+        return static_cast<f64>(platform::get_time_value() - timer.offset) * timer.seconds_per_tick;
     }
 
+    u64 get_time_ns()
+    {
+        const auto &timer = platform::g_env->timer;
+        const u64 ticks = platform::get_time_value() - timer.offset;
+        if (timer.ns_per_tick) return ticks * timer.ns_per_tick;
+        return ticks / timer.frequency * 1'000'000'000 + ticks % timer.frequency * 1'000'000'000 / timer.frequency;
+    }
+#endif
+
     void set_time(f64 time)
     {
         if (std::isnan(time) || time < 0.0 || time > 18446744073.0)
@@ -98,5 +662,9 @@ namespace awin
         }
         platform::g_env->timer.offset =
             platform::get_time_value() - static_cast<u64>(time * platform::get_time_frequency());
+#ifdef __linux__
+        platform::time_offset_ns = platform::g_env->timer.offset; // The clock of get_time_value counts nanoseconds
+#endif
+        platform::update_timers(); // The timer descriptor is armed on the absolute clock
     }
 } // namespace awin
\ No newline at end of file
@@ -1,6 +1,5 @@
 #include <X11/X.h>
 #include <awin/window.hpp>
-#include <fcntl.h>
 #include "../linux_pd.hpp"
 #include "platform.hpp"
 #include "window.hpp"
@@ -33,29 +32,6 @@ namespace awin::platform::x11
         g_ctx->dpi = dpi / 96.0f;
     }
 
-    bool create_empty_pipe()
-    {
-        if (pipe(g_ctx->empty_pipe) != 0)
-        {
-            AWIN_LOG_ERROR("Failed to create empty event pipe: %s", strerror(errno));
-            return false;
-        }
-        for (int i = 0; i < 2; i++)
-        {
-            const int sf = fcntl(g_ctx->empty_pipe[i], F_GETFL, 0);
-            const int df = fcntl(g_ctx->empty_pipe[i], F_GETFD, 0);
-
-            if (sf == -1 || df == -1 || fcntl(g_ctx->empty_pipe[i], F_SETFL, sf | O_NONBLOCK) == -1 ||
-                fcntl(g_ctx->empty_pipe[i], F_SETFD, df | FD_CLOEXEC) == -1)
-            {
-                AWIN_LOG_ERROR("Failed to set flags for empty event pipe: %s", strerror(errno));
-                close(g_ctx->empty_pipe[i]);
-                return false;
-            }
-        }
-        return true;
-    }
-
     void init_xi()
     {
         auto &xi = g_ctx->xlib.xi;
@@ -70,6 +46,15 @@ namespace awin::platform::x11
         }
     }
 
+    void init_shm()
+    {
+        auto &shm = g_ctx->xlib.shm;
+        if (!shm.load()) return;
+        AWIN_LOG_INFO("Loaded X extension library");
+        shm.init = shm.XShmQueryExtension(g_ctx->display);
+        if (shm.init) shm.event_base = shm.XShmGetEventBase(g_ctx->display);
+    }
+
     void init_xkb()
     {
         auto &xkb = g_ctx->xlib.xkb;
@@ -96,17 +81,17 @@ namespace awin::platform::x11
         AWIN_LOG_INFO("Loaded XKB");
     }
 
-    // Return the atom ID only if it is listed in the specified array
+    // Return the atom only if it is listed in the specified array
     //
-    Atom get_atom(Atom *supported_atoms, unsigned long atom_count, const char *atom_name)
+    static Atom filter_supported(Atom atom, const Atom *supported_atoms, unsigned long atom_count)
     {
-        const Atom atom = g_ctx->xlib.XInternAtom(g_ctx->display, atom_name, False);
         for (unsigned long i = 0; i < atom_count; i++)
             if (supported_atoms[i] == atom) return atom;
         return None;
     }
 
-    static void detect_ewmh()
+    // Read the atoms supported by the EWMH-compliant window manager. Returns 0 if none is running.
+    static unsigned long get_ewmh_supported_atoms(Atom **supported_atoms)
     {
         auto &xlib = g_ctx->xlib;
 
@@ -114,8 +99,8 @@ namespace awin::platform::x11
         XID *window_from_root = NULL;
         if (!get_window_property(g_ctx->root, g_ctx->wm.NET_SUPPORTING_WM_CHECK, XA_WINDOW,
                                  (unsigned char **)&window_from_root))
-            return;
-        grab_error_handler();
+            return 0;
+        grab_error_handler("EWMH detection");
 
         // If it exists, it should be the XID of a top-level window
         // Then we look for the same property on that window
@@ -126,7 +111,7 @@ namespace awin::platform::x11
         {
             release_error_handler();
             xlib.XFree(window_from_root);
-            return;
+            return 0;
         }
 
         release_error_handler();
@@ -136,7 +121,7 @@ namespace awin::platform::x11
         {
             xlib.XFree(window_from_root);
             xlib.XFree(window_from_child);
-            return;
+            return 0;
         }
 
         xlib.XFree(window_from_root);
@@ -146,78 +131,116 @@ namespace awin::platform::x11
         // We can now start querying the WM about what features it supports by
         // looking in the _NET_SUPPORTED property on the root window
         // It should contain a list of supported EWMH protocol and state atoms
+        return get_window_property(g_ctx->root, g_ctx->wm.NET_SUPPORTED, XA_ATOM, (unsigned char **)supported_atoms);
+    }
 
-        Atom *supported_atoms = NULL;
-        const unsigned long atom_count =
-            get_window_property(g_ctx->root, g_ctx->wm.NET_SUPPORTED, XA_ATOM, (unsigned char **)&supported_atoms);
+    // The EWMH atoms that are only kept if the window manager supports them
+    static Atom WMAtoms::*const ewmh_atoms[] = {
+        &WMAtoms::NET_WM_STATE,
+        &WMAtoms::NET_WM_STATE_ABOVE,
+        &WMAtoms::NET_WM_STATE_FULLSCREEN,
+        &WMAtoms::NET_WM_STATE_MAXIMIZED_VERT,
+        &WMAtoms::NET_WM_STATE_MAXIMIZED_HORZ,
+        &WMAtoms::NET_WM_STATE_DEMANDS_ATTENTION,
+        &WMAtoms::NET_WM_FULLSCREEN_MONITORS,
+        &WMAtoms::NET_WM_WINDOW_TYPE,
+        &WMAtoms::NET_WM_WINDOW_TYPE_NORMAL,
+        &WMAtoms::NET_WORKAREA,
+        &WMAtoms::NET_CURRENT_DESKTOP,
+        &WMAtoms::NET_ACTIVE_WINDOW,
+        &WMAtoms::NET_FRAME_EXTENTS,
+        &WMAtoms::NET_REQUEST_FRAME_EXTENTS,
+    };
 
+    static void detect_ewmh()
+    {
         // See which of the atoms we support that are supported by the WM
+        Atom *supported_atoms = NULL;
+        const unsigned long atom_count = get_ewmh_supported_atoms(&supported_atoms);
+        for (Atom WMAtoms::*atom : ewmh_atoms)
+            g_ctx->wm.*atom = filter_supported(g_ctx->wm.*atom, supported_atoms, atom_count);
+        if (supported_atoms) g_ctx->xlib.XFree(supported_atoms);
+    }
 
-        g_ctx->wm.NET_WM_STATE = get_atom(supported_atoms, atom_count, "_NET_WM_STATE");
-        g_ctx->wm.NET_WM_STATE_ABOVE = get_atom(supported_atoms, atom_count, "_NET_WM_STATE_ABOVE");
-        g_ctx->wm.NET_WM_STATE_FULLSCREEN = get_atom(supported_atoms, atom_count, "_NET_WM_STATE_FULLSCREEN");
-        g_ctx->wm.NET_WM_STATE_MAXIMIZED_VERT = get_atom(supported_atoms, atom_count, "_NET_WM_STATE_MAXIMIZED_VERT");
-        g_ctx->wm.NET_WM_STATE_MAXIMIZED_HORZ = get_atom(supported_atoms, atom_count, "_NET_WM_STATE_MAXIMIZED_HORZ");
-        g_ctx->wm.NET_WM_STATE_DEMANDS_ATTENTION =
-            get_atom(supported_atoms, atom_count, "_NET_WM_STATE_DEMANDS_ATTENTION");
-        g_ctx->wm.NET_WM_FULLSCREEN_MONITORS = get_atom(supported_atoms, atom_count, "_NET_WM_FULLSCREEN_MONITORS");
-        g_ctx->wm.NET_WM_WINDOW_TYPE = get_atom(supported_atoms, atom_count, "_NET_WM_WINDOW_TYPE");
-        g_ctx->wm.NET_WM_WINDOW_TYPE_NORMAL = get_atom(supported_atoms, atom_count, "_NET_WM_WINDOW_TYPE_NORMAL");
-        g_ctx->wm.NET_WORKAREA = get_atom(supported_atoms, atom_count, "_NET_WORKAREA");
-        g_ctx->wm.NET_CURRENT_DESKTOP = get_atom(supported_atoms, atom_count, "_NET_CURRENT_DESKTOP");
-        g_ctx->wm.NET_ACTIVE_WINDOW = get_atom(supported_atoms, atom_count, "_NET_ACTIVE_WINDOW");
-        g_ctx->wm.NET_FRAME_EXTENTS = get_atom(supported_atoms, atom_count, "_NET_FRAME_EXTENTS");
-        g_ctx->wm.NET_REQUEST_FRAME_EXTENTS = get_atom(supported_atoms, atom_count, "_NET_REQUEST_FRAME_EXTENTS");
-
-        if (supported_atoms) xlib.XFree(supported_atoms);
+    // Milliseconds on the monotonic clock, for startup timing before the library timer is set up
+    static f64 startup_time_ms()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1e3 + ts.tv_nsec * 1e-6;
     }
 
     void init_atoms()
     {
-        auto &xlib = g_ctx->xlib;
+        char cm_name[32];
+        snprintf(cm_name, sizeof(cm_name), "_NET_WM_CM_S%u", g_ctx->screen);
 
-        // String format atoms
-        g_ctx->select_atoms.NULL_ = xlib.XInternAtom(g_ctx->display, "NULL", False);
-        g_ctx->select_atoms.UTF8_STRING = xlib.XInternAtom(g_ctx->display, "UTF8_STRING", False);
-        g_ctx->select_atoms.ATOM_PAIR = xlib.XInternAtom(g_ctx->display, "ATOM_PAIR", False);
-
-        // Custom selection property atom
-        g_ctx->select_atoms.WINDOW_SELECTION = xlib.XInternAtom(g_ctx->display, "WINDOW_SELECTION", False);
-
-        // ICCCM standard clipboard atoms
-        g_ctx->select_atoms.TARGETS = xlib.XInternAtom(g_ctx->display, "TARGETS", False);
-        g_ctx->select_atoms.MULTIPLE = xlib.XInternAtom(g_ctx->display, "MULTIPLE", False);
-        g_ctx->select_atoms.PRIMARY = xlib.XInternAtom(g_ctx->display, "PRIMARY", False);
-        g_ctx->select_atoms.INCR = xlib.XInternAtom(g_ctx->display, "INCR", False);
-        g_ctx->select_atoms.CLIPBOARD = xlib.XInternAtom(g_ctx->display, "CLIPBOARD", False);
-
-        // Clipboard manager atoms
-        g_ctx->select_atoms.CLIPBOARD_MANAGER = xlib.XInternAtom(g_ctx->display, "CLIPBOARD_MANAGER", False);
-        g_ctx->select_atoms.SAVE_TARGETS = xlib.XInternAtom(g_ctx->display, "SAVE_TARGETS", False);
-
-        // ICCCM, EWMH and Motif window property atoms
-        // These can be set safely even without WM support
-        // The EWMH atoms that require WM support are handled in detectEWMH
-        g_ctx->wm.WM_PROTOCOLS = xlib.XInternAtom(g_ctx->display, "WM_PROTOCOLS", False);
-        g_ctx->wm.WM_STATE = xlib.XInternAtom(g_ctx->display, "WM_STATE", False);
-        g_ctx->wm.WM_DELETE_WINDOW = xlib.XInternAtom(g_ctx->display, "WM_DELETE_WINDOW", False);
-        g_ctx->wm.NET_SUPPORTED = xlib.XInternAtom(g_ctx->display, "_NET_SUPPORTED", False);
-        g_ctx->wm.NET_SUPPORTING_WM_CHECK = xlib.XInternAtom(g_ctx->display, "_NET_SUPPORTING_WM_CHECK", False);
-        g_ctx->wm.NET_WM_ICON = xlib.XInternAtom(g_ctx->display, "_NET_WM_ICON", False);
-        g_ctx->wm.NET_WM_PING = xlib.XInternAtom(g_ctx->display, "_NET_WM_PING", False);
-        g_ctx->wm.NET_WM_PID = xlib.XInternAtom(g_ctx->display, "_NET_WM_PID", False);
-        g_ctx->wm.NET_WM_NAME = xlib.XInternAtom(g_ctx->display, "_NET_WM_NAME", False);
-        g_ctx->wm.NET_WM_ICON_NAME = xlib.XInternAtom(g_ctx->display, "_NET_WM_ICON_NAME", False);
-        g_ctx->wm.NET_WM_BYPASS_COMPOSITOR = xlib.XInternAtom(g_ctx->display, "_NET_WM_BYPASS_COMPOSITOR", False);
-        g_ctx->wm.NET_WM_WINDOW_OPACITY = xlib.XInternAtom(g_ctx->display, "_NET_WM_WINDOW_OPACITY", False);
-        g_ctx->wm.MOTIF_WM_HINTS = xlib.XInternAtom(g_ctx->display, "_MOTIF_WM_HINTS", False);
-
-        // The compositing manager selection name contains the screen number
+        struct AtomName
         {
-            char name[32];
-            snprintf(name, sizeof(name), "_NET_WM_CM_S%u", g_ctx->screen);
-            g_ctx->wm.NET_WM_CM_Sx = xlib.XInternAtom(g_ctx->display, name, False);
-        }
+            const char *name;
+            Atom *atom;
+        };
+        auto &wm = g_ctx->wm;
+        auto &sel = g_ctx->select_atoms;
+        const AtomName names[] = {
+            // String format atoms
+            {"NULL", &sel.NULL_},
+            {"UTF8_STRING", &sel.UTF8_STRING},
+            {"ATOM_PAIR", &sel.ATOM_PAIR},
+            // Custom selection property atom
+            {"WINDOW_SELECTION", &sel.WINDOW_SELECTION},
+            // ICCCM standard clipboard atoms
+            {"TARGETS", &sel.TARGETS},
+            {"MULTIPLE", &sel.MULTIPLE},
+            {"PRIMARY", &sel.PRIMARY},
+            {"INCR", &sel.INCR},
+            {"CLIPBOARD", &sel.CLIPBOARD},
+            // Clipboard manager atoms
+            {"CLIPBOARD_MANAGER", &sel.CLIPBOARD_MANAGER},
+            {"SAVE_TARGETS", &sel.SAVE_TARGETS},
+            // ICCCM, EWMH and Motif window property atoms
+            // These can be set safely even without WM support
+            {"WM_PROTOCOLS", &wm.WM_PROTOCOLS},
+            {"WM_STATE", &wm.WM_STATE},
+            {"WM_DELETE_WINDOW", &wm.WM_DELETE_WINDOW},
+            {"_NET_SUPPORTED", &wm.NET_SUPPORTED},
+            {"_NET_SUPPORTING_WM_CHECK", &wm.NET_SUPPORTING_WM_CHECK},
+            {"_NET_WM_ICON", &wm.NET_WM_ICON},
+            {"_NET_WM_PING", &wm.NET_WM_PING},
+            {"_NET_WM_PID", &wm.NET_WM_PID},
+            {"_NET_WM_NAME", &wm.NET_WM_NAME},
+            {"_NET_WM_ICON_NAME", &wm.NET_WM_ICON_NAME},
+            {"_NET_WM_BYPASS_COMPOSITOR", &wm.NET_WM_BYPASS_COMPOSITOR},
+            {"_NET_WM_WINDOW_OPACITY", &wm.NET_WM_WINDOW_OPACITY},
+            {"_MOTIF_WM_HINTS", &wm.MOTIF_WM_HINTS},
+            // The compositing manager selection name contains the screen number
+            {cm_name, &wm.NET_WM_CM_Sx},
+            // The EWMH atoms that require WM support, dropped by detect_ewmh if unsupported
+            {"_NET_WM_STATE", &wm.NET_WM_STATE},
+            {"_NET_WM_STATE_ABOVE", &wm.NET_WM_STATE_ABOVE},
+            {"_NET_WM_STATE_FULLSCREEN", &wm.NET_WM_STATE_FULLSCREEN},
+            {"_NET_WM_STATE_MAXIMIZED_VERT", &wm.NET_WM_STATE_MAXIMIZED_VERT},
+            {"_NET_WM_STATE_MAXIMIZED_HORZ", &wm.NET_WM_STATE_MAXIMIZED_HORZ},
+            {"_NET_WM_STATE_DEMANDS_ATTENTION", &wm.NET_WM_STATE_DEMANDS_ATTENTION},
+            {"_NET_WM_FULLSCREEN_MONITORS", &wm.NET_WM_FULLSCREEN_MONITORS},
+            {"_NET_WM_WINDOW_TYPE", &wm.NET_WM_WINDOW_TYPE},
+            {"_NET_WM_WINDOW_TYPE_NORMAL", &wm.NET_WM_WINDOW_TYPE_NORMAL},
+            {"_NET_WORKAREA", &wm.NET_WORKAREA},
+            {"_NET_CURRENT_DESKTOP", &wm.NET_CURRENT_DESKTOP},
+            {"_NET_ACTIVE_WINDOW", &wm.NET_ACTIVE_WINDOW},
+            {"_NET_FRAME_EXTENTS", &wm.NET_FRAME_EXTENTS},
+            {"_NET_REQUEST_FRAME_EXTENTS", &wm.NET_REQUEST_FRAME_EXTENTS},
+        };
+        constexpr int count = sizeof(names) / sizeof(names[0]);
+
+        // All atoms are interned with a single request instead of one round trip each
+        const f64 start = startup_time_ms();
+        char *name_list[count];
+        Atom atoms[count] = {};
+        for (int i = 0; i < count; ++i) name_list[i] = const_cast<char *>(names[i].name);
+        g_ctx->xlib.XInternAtoms(g_ctx->display, name_list, count, False, atoms);
+        for (int i = 0; i < count; ++i) *names[i].atom = atoms[i];
+        AWIN_LOG_INFO("Interned %d X11 atoms in %.2f ms", count, startup_time_ms() - start);
 
         // Detect whether an EWMH-conformant window manager is running
         detect_ewmh();
@@ -313,6 +336,7 @@ namespace awin::platform::x11
 
     bool init_platform()
     {
+        const f64 start = startup_time_ms();
         if (!g_ctx)
         {
             g_ctx = acul::alloc<Context>();
@@ -338,6 +362,16 @@ namespace awin::platform::x11
             return false;
         }
         AWIN_LOG_INFO("Connected to X11 display");
+        g_ctx->error_handler = xlib.XSetErrorHandler(error_handler);
+#ifndef ACUL_BUILD_MIN
+        // Event queue ownership has to change before anything reads events
+        if (g_ctx->xlib.xcb.load() && g_ctx->xlib.xcb.XGetXCBConnection)
+        {
+            AWIN_LOG_INFO("Loaded XCB");
+            g_ctx->xcb_connection = g_ctx->xlib.xcb.XGetXCBConnection(g_ctx->display);
+        }
+        if (g_env->xcb_events) init_xcb_events();
+#endif
 
         g_ctx->xlib.xkb.load(xlib.handle);
         g_ctx->utf8 = xlib.Xutf8LookupString && xlib.Xutf8SetWMProperties;
@@ -346,17 +380,14 @@ namespace awin::platform::x11
         g_ctx->context = (XContext)xlib.XrmUniqueQuark();
         set_system_dpi();
 
-        if (!create_empty_pipe()) return false;
         init_xi();
+        init_shm();
         if (g_ctx->xlib.xcursor.load()) AWIN_LOG_INFO("Loaded Xcursor library");
-#ifndef ACUL_BUILD_MIN
-        if (g_ctx->xlib.xcb.load()) AWIN_LOG_INFO("Loaded XCB");
-#endif
         init_atoms();
         g_ctx->helper_window = create_helper_window();
         create_hidden_cursor(g_ctx->hidden_cursor);
 
-        if (xlib.XSupportsLocale() && g_ctx->utf8)
+        if (!g_ctx->xcb_owns_events && xlib.XSupportsLocale() && g_ctx->utf8)
         {
             xlib.XSetLocaleModifiers("");
             // If an IM is already present our callback will be called right away
@@ -364,7 +395,7 @@ namespace awin::platform::x11
                                                 NULL);
         }
 
-        AWIN_LOG_INFO("Created X11 Window Context");
+        AWIN_LOG_INFO("Created X11 Window Context in %.2f ms", startup_time_ms() - start);
         return true;
     }
 
@@ -394,16 +425,18 @@ namespace awin::platform::x11
 
         if (g_ctx->display)
         {
+            // Errors still in flight are reported under their scopes before the previous handler is restored
+            if (!g_ctx->error_scopes.empty())
+            {
+                xlib.XSync(g_ctx->display, False);
+                if (g_ctx->xcb_owns_events) process_xcb_errors();
+            }
+            release_xcb_events();
+            xlib.XSetErrorHandler(g_ctx->error_handler);
             xlib.XCloseDisplay(g_ctx->display);
             g_ctx->display = NULL;
         }
 
-        if (g_ctx->empty_pipe[0] || g_ctx->empty_pipe[1])
-        {
-            close(g_ctx->empty_pipe[0]);
-            close(g_ctx->empty_pipe[1]);
-        }
-
         acul::release(g_ctx);
         g_ctx = nullptr;
     }
@@ -418,12 +451,14 @@ namespace awin::platform::x11
         caller.poll_events = poll_events;
         caller.wait_events = wait_events;
         caller.wait_events_timeout = wait_events_timeout;
-        caller.push_empty_event = push_empty_event;
+        caller.get_event_fds = get_event_fds;
         caller.get_dpi = get_dpi;
         caller.get_window_size = get_window_size;
         caller.get_clipboard_string = get_clipboard_string;
         caller.set_clipboard_string = set_clipboard_string;
         caller.get_primary_monitor_info = get_primary_monitor_info;
+        caller.begin_batch = begin_batch;
+        caller.end_batch = end_batch;
     }
 
     void init_wcall_data(LinuxWindowCaller &caller)
@@ -438,6 +473,7 @@ namespace awin::platform::x11
         caller.enable_fullscreen = enable_fullscreen;
         caller.disable_fullscreen = disable_fullscreen;
         caller.get_cursor_position = get_cursor_position;
+        caller.query_cursor_position = query_cursor_position;
         caller.set_cursor_position = set_cursor_position;
         caller.hide_cursor = hide_cursor;
         caller.show_cursor = show_cursor;
@@ -967,7 +967,7 @@ namespace awin::platform::x11
             xlib.XConvertSelection(g_ctx->display, selection, target, g_ctx->select_atoms.WINDOW_SELECTION,
                                    g_ctx->helper_window, CurrentTime);
 
-            while (!xlib.XCheckTypedWindowEvent(g_ctx->display, g_ctx->helper_window, SelectionNotify, &event))
+            while (!check_typed_window_event(g_ctx->helper_window, SelectionNotify, &event))
                 wait_for_x11_event(nullptr);
 
             auto *sel = &event.xselection;
@@ -987,7 +987,7 @@ namespace awin::platform::x11
                 while (true)
                 {
                     XEvent dummy;
-                    while (!xlib.XCheckIfEvent(g_ctx->display, &dummy, is_sel_prop_new_value_notify, (XPointer)&event))
+                    while (!check_if_event(&dummy, is_sel_prop_new_value_notify, (XPointer)&event))
                         wait_for_x11_event(nullptr);
 
                     xlib.XFree(data);
@@ -1099,8 +1099,7 @@ namespace awin::platform::x11
                 {
                     const char *c = utf8.c_str();
                     while (static_cast<size_t>(c - utf8.c_str()) < utf8.size())
-                        acul::events::dispatch_event_group<CharInputEvent>(g_env->events.char_input, window_data->owner,
-                                                                           decode_utf8(&c));
+                        dispatch_event<CharInputEvent>(g_env->events.char_input, window_data->owner, decode_utf8(&c));
                 }
             }
         }
@@ -1113,8 +1112,7 @@ namespace awin::platform::x11
 
             const u32 codepoint = keysym_to_unicode(keysym);
             if (codepoint != UINT32_MAX)
-                acul::events::dispatch_event_group<CharInputEvent>(g_env->events.char_input, window_data->owner,
-                                                                   codepoint);
+                dispatch_event<CharInputEvent>(g_env->events.char_input, window_data->owner, codepoint);
         }
     }
 
@@ -1122,18 +1120,15 @@ namespace awin::platform::x11
     {
         const auto key = g_ctx->keymap.find(keycode);
         const io::KeyMode mods = translate_state(event->xkey.state);
-        auto &xlib = g_ctx->xlib;
         if (!g_ctx->xlib.xkb.detectable)
         {
             // HACK: Key repeat events will arrive as KeyRelease/KeyPress
             //       pairs with similar or identical time stamps
             //       The key repeat logic in _glfwInputKey expects only key
             //       presses to repeat, so detect and discard release events
-            if (xlib.XEventsQueued(g_ctx->display, QueuedAfterReading))
+            XEvent next;
+            if (peek_queued_event(&next))
             {
-                XEvent next;
-                xlib.XPeekEvent(g_ctx->display, &next);
-
                 if (next.type == KeyPress && next.xkey.window == event->xkey.window && next.xkey.keycode == keycode)
                 {
                     // HACK: The time of repeat events sometimes doesn't
@@ -1160,33 +1155,29 @@ namespace awin::platform::x11
         switch (event->xbutton.button)
         {
             case Button1:
-                acul::events::dispatch_event_group<MouseClickEvent>(g_env->events.mouse_click, window_data->owner,
-                                                                    io::MouseKey::left, io::KeyPressState::press);
+                input_mouse_click(window_data, io::MouseKey::left, io::KeyPressState::press);
                 return;
             case Button2:
-                acul::events::dispatch_event_group<MouseClickEvent>(g_env->events.mouse_click, window_data->owner,
-                                                                    io::MouseKey::middle, io::KeyPressState::press);
+                input_mouse_click(window_data, io::MouseKey::middle, io::KeyPressState::press);
                 return;
             case Button3:
-                acul::events::dispatch_event_group<MouseClickEvent>(g_env->events.mouse_click, window_data->owner,
-                                                                    io::MouseKey::right, io::KeyPressState::press);
+                input_mouse_click(window_data, io::MouseKey::right, io::KeyPressState::press);
                 return;
                 // Modern X provides scroll events as mouse button presses
             case Button4:
-                acul::events::dispatch_event_group<ScrollEvent>(g_env->events.scroll, window_data->owner, 0.0, 1.0);
+                input_scroll(window_data, 0.0f, 1.0f);
                 return;
             case Button5:
-                acul::events::dispatch_event_group<ScrollEvent>(g_env->events.scroll, window_data->owner, 0.0, -1.0);
+                input_scroll(window_data, 0.0f, -1.0f);
                 return;
             case Button6:
-                acul::events::dispatch_event_group<ScrollEvent>(g_env->events.scroll, window_data->owner, 1.0, 0.0);
+                input_scroll(window_data, 1.0f, 0.0f);
                 return;
             case Button7:
-                acul::events::dispatch_event_group<ScrollEvent>(g_env->events.scroll, window_data->owner, -1.0, 0.0);
+                input_scroll(window_data, -1.0f, 0.0f);
                 return;
             default:
-                acul::events::dispatch_event_group<MouseClickEvent>(g_env->events.mouse_click, window_data->owner,
-                                                                    io::MouseKey::unknown, io::KeyPressState::press);
+                input_mouse_click(window_data, io::MouseKey::unknown, io::KeyPressState::press);
                 return;
         }
     }
@@ -1196,20 +1187,16 @@ namespace awin::platform::x11
         switch (event->xbutton.button)
         {
             case Button1:
-                acul::events::dispatch_event_group<MouseClickEvent>(g_env->events.mouse_click, window_data->owner,
-                                                                    io::MouseKey::left, io::KeyPressState::release);
+                input_mouse_click(window_data, io::MouseKey::left, io::KeyPressState::release);
                 return;
             case Button2:
-                acul::events::dispatch_event_group<MouseClickEvent>(g_env->events.mouse_click, window_data->owner,
-                                                                    io::MouseKey::middle, io::KeyPressState::release);
+                input_mouse_click(window_data, io::MouseKey::middle, io::KeyPressState::release);
                 return;
             case Button3:
-                acul::events::dispatch_event_group<MouseClickEvent>(g_env->events.mouse_click, window_data->owner,
-                                                                    io::MouseKey::right, io::KeyPressState::release);
+                input_mouse_click(window_data, io::MouseKey::right, io::KeyPressState::release);
                 return;
             default:
-                acul::events::dispatch_event_group<MouseClickEvent>(g_env->events.mouse_click, window_data->owner,
-                                                                    io::MouseKey::unknown, io::KeyPressState::press);
+                input_mouse_click(window_data, io::MouseKey::unknown, io::KeyPressState::press);
         }
     }
 } // namespace awin::platform::x11
\ No newline at end of file
@@ -33,6 +33,8 @@ namespace awin::platform::x11
         LOAD_FUNCTION(XConvertSelection, handle);
         LOAD_FUNCTION(XCreateColormap, handle);
         LOAD_FUNCTION(XCreateFontCursor, handle);
+        LOAD_FUNCTION(XCreateGC, handle);
+        LOAD_FUNCTION(XCreateImage, handle);
         LOAD_FUNCTION(XCreateIC, handle);
         LOAD_FUNCTION(XCreateRegion, handle);
         LOAD_FUNCTION(XCreateWindow, handle);
@@ -43,11 +45,13 @@ namespace awin::platform::x11
         LOAD_FUNCTION(XDestroyRegion, handle);
         LOAD_FUNCTION(XDestroyWindow, handle);
         LOAD_FUNCTION(XDisplayKeycodes, handle);
+        LOAD_FUNCTION(XESetWireToEvent, handle);
         LOAD_FUNCTION(XEventsQueued, handle);
         LOAD_FUNCTION(XFilterEvent, handle);
         LOAD_FUNCTION(XFindContext, handle);
         LOAD_FUNCTION(XFlush, handle);
         LOAD_FUNCTION(XFree, handle);
+        LOAD_FUNCTION(XFreeGC, handle);
         LOAD_FUNCTION(XGetAtomName, handle);
         LOAD_FUNCTION(XFreeColormap, handle);
         LOAD_FUNCTION(XFreeCursor, handle);
@@ -68,6 +72,7 @@ namespace awin::platform::x11
         LOAD_FUNCTION(XIconifyWindow, handle);
         LOAD_FUNCTION(XInitThreads, handle);
         LOAD_FUNCTION(XInternAtom, handle);
+        LOAD_FUNCTION(XInternAtoms, handle);
         LOAD_FUNCTION(XLookupString, handle);
         LOAD_FUNCTION(Xutf8LookupString, handle);
         LOAD_FUNCTION(Xutf8SetWMProperties, handle);
@@ -80,6 +85,7 @@ namespace awin::platform::x11
         LOAD_FUNCTION(XOpenIM, handle);
         LOAD_FUNCTION(XPeekEvent, handle);
         LOAD_FUNCTION(XPending, handle);
+        LOAD_FUNCTION(XPutImage, handle);
         LOAD_FUNCTION(XrmDestroyDatabase, handle);
         LOAD_FUNCTION(XrmGetResource, handle);
         LOAD_FUNCTION(XrmGetStringDatabase, handle);
@@ -148,6 +154,30 @@ namespace awin::platform::x11
         return true;
     }
 
+    bool XShmLoader::load()
+    {
+#if defined(__CYGWIN__)
+        handle = dlopen("libXext-6.so", RTLD_LAZY);
+#elif defined(__OpenBSD__) || defined(__NetBSD__)
+        handle = dlopen("libXext.so", RTLD_LAZY);
+#else
+        handle = dlopen("libXext.so.6", RTLD_LAZY);
+#endif
+        if (!handle)
+        {
+            AWIN_LOG_WARN("Failed to load X extension library: %s", dlerror());
+            return false;
+        }
+
+        LOAD_FUNCTION(XShmQueryExtension, handle);
+        LOAD_FUNCTION(XShmGetEventBase, handle);
+        LOAD_FUNCTION(XShmCreateImage, handle);
+        LOAD_FUNCTION(XShmAttach, handle);
+        LOAD_FUNCTION(XShmDetach, handle);
+        LOAD_FUNCTION(XShmPutImage, handle);
+        return XShmQueryExtension && XShmGetEventBase && XShmCreateImage && XShmAttach && XShmDetach && XShmPutImage;
+    }
+
     bool XCursorLoader::load()
     {
 #if defined(__CYGWIN__)
@@ -186,6 +216,13 @@ namespace awin::platform::x11
         }
 
         LOAD_FUNCTION(XGetXCBConnection, handle);
+        LOAD_FUNCTION(XSetEventQueueOwner, handle);
+        // Resolved from libxcb, a dependency of libX11-xcb
+        LOAD_FUNCTION(xcb_poll_for_event, handle);
+        LOAD_FUNCTION(xcb_poll_for_queued_event, handle);
+        LOAD_FUNCTION(xcb_get_property, handle);
+        LOAD_FUNCTION(xcb_get_property_reply, handle);
+        LOAD_FUNCTION(xcb_get_property_value, handle);
 
         return true;
     }
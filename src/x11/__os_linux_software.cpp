@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include "platform.hpp"
+#include "window.hpp"
+
+// Software surfaces. The buffers are MIT-SHM images the server reads from shared memory. When the extension is
+// missing or the server cannot attach the segment, as with remote displays, the images are sent over the connection
+// instead.
+namespace awin::platform::x11
+{
+    static void destroy_buffer(X11SoftwareBuffer &buffer)
+    {
+        if (!buffer.image) return;
+        if (buffer.shm.shmid != -1)
+        {
+            // The server drops its mapping with the detach, after the images still queued before it
+            g_ctx->xlib.shm.XShmDetach(g_ctx->display, &buffer.shm);
+            shmdt(buffer.shm.shmaddr);
+            buffer.image->data = nullptr;
+        }
+        XDestroyImage(buffer.image);
+        buffer.image = nullptr;
+    }
+
+    static bool attach_shm_image(X11SoftwareSurface *surface, X11SoftwareBuffer &buffer)
+    {
+        auto &shm = g_ctx->xlib.shm;
+        buffer.image = shm.XShmCreateImage(g_ctx->display, surface->visual, surface->depth, ZPixmap, NULL, &buffer.shm,
+                                           surface->size.x, surface->size.y);
+        if (!buffer.image) return false;
+
+        buffer.shm.shmid = shmget(IPC_PRIVATE, buffer.image->bytes_per_line * buffer.image->height, IPC_CREAT | 0600);
+        if (buffer.shm.shmid == -1)
+        {
+            XDestroyImage(buffer.image);
+            buffer.image = nullptr;
+            return false;
+        }
+        buffer.shm.shmaddr = buffer.image->data = (char *)shmat(buffer.shm.shmid, NULL, 0);
+        buffer.shm.readOnly = False;
+
+        bool attached = buffer.shm.shmaddr != (char *)-1;
+        if (attached)
+        {
+            grab_error_handler("MIT-SHM attach");
+            shm.XShmAttach(g_ctx->display, &buffer.shm);
+            release_error_handler(true);
+            attached = g_ctx->error_code == Success;
+        }
+
+        // The segment is freed once the server and the client have detached
+        shmctl(buffer.shm.shmid, IPC_RMID, NULL);
+        if (attached) return true;
+
+        if (buffer.shm.shmaddr != (char *)-1) shmdt(buffer.shm.shmaddr);
+        buffer.shm.shmid = -1;
+        buffer.image->data = nullptr;
+        XDestroyImage(buffer.image);
+        buffer.image = nullptr;
+        return false;
+    }
+
+    static bool create_buffer(X11SoftwareSurface *surface, X11SoftwareBuffer &buffer)
+    {
+        buffer = {};
+        buffer.shm.shmid = -1;
+        if (surface->use_shm && !attach_shm_image(surface, buffer))
+        {
+            AWIN_LOG_WARN("MIT-SHM is not usable on this display, sending software surface images over the connection");
+            surface->use_shm = false;
+        }
+
+        if (!buffer.image)
+        {
+            const int stride = surface->size.x * 4;
+            char *data = (char *)malloc((size_t)stride * surface->size.y);
+            if (!data) return false;
+            buffer.image = g_ctx->xlib.XCreateImage(g_ctx->display, surface->visual, surface->depth, ZPixmap, 0, data,
+                                                    surface->size.x, surface->size.y, 32, stride);
+            if (!buffer.image)
+            {
+                free(data);
+                return false;
+            }
+        }
+
+        // Buffer pixels are handed out as 0xAARRGGBB words
+        if (buffer.image->bits_per_pixel != 32)
+        {
+            AWIN_LOG_ERROR("The server stores the window pixels in %d bits, software surfaces need 32",
+                           buffer.image->bits_per_pixel);
+            destroy_buffer(buffer);
+            return false;
+        }
+        return true;
+    }
+
+    static bool create_buffers(X11SoftwareSurface *surface)
+    {
+        for (auto &buffer : surface->buffers) destroy_buffer(buffer);
+        surface->size = surface->window->dimenstions;
+        for (auto &buffer : surface->buffers)
+            if (!create_buffer(surface, buffer))
+            {
+                surface->size = {0, 0}; // Retried by the next acquire
+                return false;
+            }
+        return true;
+    }
+
+    static void destroy_software_surface(SoftwareSurface::Platform *pd)
+    {
+        auto *surface = (X11SoftwareSurface *)pd;
+        for (auto &buffer : surface->buffers) destroy_buffer(buffer);
+        if (surface->gc) g_ctx->xlib.XFreeGC(g_ctx->display, surface->gc);
+        auto &surfaces = g_ctx->software_surfaces;
+        surfaces.erase(std::remove(surfaces.begin(), surfaces.end(), surface), surfaces.end());
+        flush_requests();
+        acul::release(surface);
+    }
+
+    static SoftwareSurface::Platform *create_software_surface(WindowData *window_data, u32 buffer_count)
+    {
+        auto *x11_data = (X11WindowData *)window_data;
+        XWindowAttributes attribs;
+        if (!g_ctx->xlib.XGetWindowAttributes(g_ctx->display, x11_data->window, &attribs)) return nullptr;
+        const Visual *visual = attribs.visual;
+        if (visual->red_mask != 0xFF0000 || visual->green_mask != 0xFF00 || visual->blue_mask != 0xFF)
+        {
+            AWIN_LOG_ERROR("The window visual has no 32-bit RGB pixel format for software surfaces");
+            return nullptr;
+        }
+
+        auto *surface = acul::alloc<X11SoftwareSurface>();
+        surface->window = window_data;
+        surface->handle = x11_data->window;
+        surface->gc = g_ctx->xlib.XCreateGC(g_ctx->display, x11_data->window, 0, NULL);
+        surface->visual = attribs.visual;
+        surface->depth = attribs.depth;
+        surface->use_shm = g_ctx->xlib.shm.init;
+        surface->size = {0, 0};
+        surface->buffers.resize(buffer_count);
+        for (auto &buffer : surface->buffers) buffer = {};
+        g_ctx->software_surfaces.push_back(surface);
+        return surface;
+    }
+
+    static bool acquire_software_buffer(SoftwareSurface::Platform *pd, SoftwareSurface::Buffer &out)
+    {
+        auto *surface = (X11SoftwareSurface *)pd;
+        const acul::point2D<i32> size = surface->window->dimenstions;
+        if (size.x <= 0 || size.y <= 0) return false;
+        if (!(surface->size == size) && !create_buffers(surface)) return false;
+
+        // The free buffer shown longest ago
+        int index = -1;
+        for (int i = 0; i < (int)surface->buffers.size(); ++i)
+        {
+            const auto &buffer = surface->buffers[i];
+            if (!buffer.image || buffer.busy) continue;
+            if (index == -1 || buffer.presented < surface->buffers[index].presented) index = i;
+        }
+        if (index == -1) return false;
+
+        const auto &buffer = surface->buffers[index];
+        surface->acquired = index;
+        out.pixels = (u32 *)buffer.image->data;
+        out.stride = buffer.image->bytes_per_line / 4;
+        out.size = size;
+        out.age = surface->buffer_age(buffer.presented);
+        return true;
+    }
+
+    static void present_software_buffer(SoftwareSurface::Platform *pd, std::span<const DamageRect> damage)
+    {
+        auto *surface = (X11SoftwareSurface *)pd;
+        auto &buffer = surface->buffers[surface->acquired];
+        surface->acquired = -1;
+
+        // Clip the damage to the image, the completion is requested with the last put
+        acul::vector<DamageRect> rects;
+        const DamageRect full{0, 0, surface->size.x, surface->size.y};
+        if (damage.empty()) damage = {&full, 1};
+        for (const auto &rect : damage)
+        {
+            const i32 x = std::max(rect.x, 0), y = std::max(rect.y, 0);
+            const i32 right = std::min(rect.x + rect.width, surface->size.x);
+            const i32 bottom = std::min(rect.y + rect.height, surface->size.y);
+            if (right > x && bottom > y) rects.push_back({x, y, right - x, bottom - y});
+        }
+
+        auto &xlib = g_ctx->xlib;
+        for (size_t i = 0; i < rects.size(); ++i)
+        {
+            const auto &r = rects[i];
+            if (buffer.shm.shmid != -1)
+                xlib.shm.XShmPutImage(g_ctx->display, surface->handle, surface->gc, buffer.image, r.x, r.y, r.x, r.y,
+                                      r.width, r.height, i + 1 == rects.size());
+            else
+                xlib.XPutImage(g_ctx->display, surface->handle, surface->gc, buffer.image, r.x, r.y, r.x, r.y, r.width,
+                               r.height);
+        }
+        if (!rects.empty() && buffer.shm.shmid != -1) buffer.busy = true;
+        flush_requests();
+
+        buffer.presented = ++surface->presents;
+    }
+
+    void on_shm_completion(const XShmCompletionEvent *event)
+    {
+        for (auto *surface : g_ctx->software_surfaces)
+            for (auto &buffer : surface->buffers)
+                if (buffer.shm.shmid != -1 && buffer.shm.shmseg == event->shmseg)
+                {
+                    buffer.busy = false;
+                    return;
+                }
+    }
+
+    void init_scall_data(LinuxSoftwareCaller &caller)
+    {
+        caller.create = create_software_surface;
+        caller.acquire = acquire_software_buffer;
+        caller.present = present_software_buffer;
+        caller.destroy = destroy_software_surface;
+    }
+} // namespace awin::platform::x11
@@ -176,7 +176,7 @@ namespace awin
             {
                 XEvent event;
 
-                while (xlib.XCheckIfEvent(g_ctx->display, &event, is_selection_event, NULL))
+                while (check_if_event(&event, is_selection_event, NULL))
                 {
                     switch (event.type)
                     {
@@ -233,6 +233,11 @@ namespace awin
         acul::string get_window_title(WindowData *window_data)
         {
             auto *x11_data = (X11WindowData *)window_data;
+            if (x11_data->title_known)
+            {
+                ++g_ctx->round_trips_avoided;
+                return x11_data->title;
+            }
             auto &xlib = g_ctx->xlib;
             Atom actual_type;
             int actual_format;
@@ -243,13 +248,12 @@ namespace awin
                                                  False, g_ctx->select_atoms.UTF8_STRING, &actual_type, &actual_format,
                                                  &nitems, &bytes_after, &prop);
 
+            x11_data->title.clear();
             if (status == Success && prop && actual_type == g_ctx->select_atoms.UTF8_STRING)
-            {
-                acul::string result(reinterpret_cast<const char *>(prop), nitems);
-                xlib.XFree(prop);
-                return result;
-            }
-            return {};
+                x11_data->title.assign(reinterpret_cast<const char *>(prop), nitems);
+            if (prop) xlib.XFree(prop);
+            x11_data->title_known = status == Success;
+            return x11_data->title;
         }
 
         void set_window_title(WindowData *window_data, const acul::string &title)
@@ -265,7 +269,10 @@ namespace awin
             xlib.XChangeProperty(g_ctx->display, x11_data->window, g_ctx->wm.NET_WM_ICON_NAME,
                                  g_ctx->select_atoms.UTF8_STRING, 8, PropModeReplace, (unsigned char *)pTitle,
                                  title.length());
-            xlib.XFlush(g_ctx->display);
+            flush_requests();
+            x11_data->title = title;
+            x11_data->title_known = true;
+            ++x11_data->own_title_writes;
         }
 
         void enable_fullscreen(WindowData *window_data)
@@ -286,7 +293,7 @@ namespace awin
 
             g_ctx->xlib.XSendEvent(g_ctx->display, g_ctx->root, False,
                                    SubstructureNotifyMask | SubstructureRedirectMask, &e);
-            g_ctx->xlib.XFlush(g_ctx->display);
+            flush_requests();
         }
 
         void disable_fullscreen(WindowData *window_data)
@@ -307,7 +314,7 @@ namespace awin
 
             g_ctx->xlib.XSendEvent(g_ctx->display, g_ctx->root, False,
                                    SubstructureNotifyMask | SubstructureRedirectMask, &e);
-            g_ctx->xlib.XFlush(g_ctx->display);
+            flush_requests();
         }
 
         bool bind_wm_to_window(X11WindowData *window, const acul::string &title, i32 width, i32 height,
@@ -420,7 +427,7 @@ namespace awin
         bool wait_for_x11_event(f64 *timeout)
         {
             struct pollfd fd = {ConnectionNumber(g_ctx->display), POLLIN};
-            while (!g_ctx->xlib.XPending(g_ctx->display))
+            while (!has_queued_events())
                 if (!poll_posix(&fd, 1, timeout)) return false;
             return true;
         }
@@ -432,11 +439,13 @@ namespace awin
         static bool wait_for_any_event(f64 *timeout)
         {
             struct pollfd fds[] = {
-                {ConnectionNumber(g_ctx->display), POLLIN}, {g_ctx->empty_pipe[0], POLLIN}, {-1, POLLIN}};
+                {ConnectionNumber(g_ctx->display), POLLIN}, {g_env->wake.fd, POLLIN}, {-1, POLLIN}};
 
-            while (!g_ctx->xlib.XPending(g_ctx->display))
+            while (!has_queued_events())
             {
-                if (!poll_posix(fds, sizeof(fds) / sizeof(fds[0]), timeout)) return false;
+                bool watched;
+                if (!poll_watched(fds, sizeof(fds) / sizeof(fds[0]), timeout, watched)) return false;
+                if (watched) return true;
                 for (size_t i = 1; i < sizeof(fds) / sizeof(fds[0]); i++)
                     if (fds[i].revents & POLLIN) return true;
             }
@@ -448,7 +457,7 @@ namespace awin
         {
             XEvent dummy;
             f64 timeout = 0.1;
-            while (!g_ctx->xlib.XCheckTypedWindowEvent(g_ctx->display, window_data->window, VisibilityNotify, &dummy))
+            while (!check_typed_window_event(window_data->window, VisibilityNotify, &dummy))
                 if (!wait_for_x11_event(&timeout)) return false;
             return true;
         }
@@ -472,7 +481,7 @@ namespace awin
                 ev.xclient.data.l[3] = 1; // source = application
                 g_ctx->xlib.XSendEvent(g_ctx->display, g_ctx->root, False,
                                        SubstructureRedirectMask | SubstructureNotifyMask, &ev);
-                g_ctx->xlib.XFlush(g_ctx->display);
+                flush_requests();
             }
         }
 
@@ -480,18 +489,7 @@ namespace awin
         {
             auto *x11 = (X11WindowData *)window_data;
             g_ctx->xlib.XUnmapWindow(g_ctx->display, x11->window);
-            g_ctx->xlib.XFlush(g_ctx->display);
-        }
-
-        // Drains available data from the empty event pipe
-        static void drain_empty_events()
-        {
-            while (true)
-            {
-                char dummy[64];
-                const ssize_t result = read(g_ctx->empty_pipe[0], dummy, sizeof(dummy));
-                if (result == -1 && errno != EINTR) break;
-            }
+            flush_requests();
         }
 
         // Returns whether the window is iconified
@@ -541,7 +539,7 @@ namespace awin
         // Ungrabs the cursor
         static void release_cursor() { g_ctx->xlib.XUngrabPointer(g_ctx->display, CurrentTime); }
 
-        acul::point2D<i32> get_cursor_position(WindowData *window_data)
+        acul::point2D<i32> query_cursor_position(WindowData *window_data)
         {
             auto *x11_data = (X11WindowData *)window_data;
             auto &xlib = g_ctx->xlib;
@@ -549,10 +547,33 @@ namespace awin
             int root_x, root_y, win_x, win_y;
             unsigned int mask_return;
 
-            if (xlib.XQueryPointer(g_ctx->display, x11_data->window, &root_return, &child_return, &root_x, &root_y,
-                                   &win_x, &win_y, &mask_return))
-                return {win_x, win_y};
-            return {};
+            if (!xlib.XQueryPointer(g_ctx->display, x11_data->window, &root_return, &child_return, &root_x, &root_y,
+                                    &win_x, &win_y, &mask_return))
+                return {};
+            x11_data->cursor_pos = {win_x, win_y};
+            x11_data->cursor_pos_known = true;
+            return x11_data->cursor_pos;
+        }
+
+        // Served from the pointer events of the window, the server is only asked while no event has reported the
+        // current position (before the first one, after the pointer left the window or the window moved)
+        acul::point2D<i32> get_cursor_position(WindowData *window_data)
+        {
+            auto *x11_data = (X11WindowData *)window_data;
+            if (x11_data->cursor_pos_known) return x11_data->cursor_pos;
+            return query_cursor_position(window_data);
+        }
+
+        static void track_cursor_pos(X11WindowData *window_data, acul::point2D<i32> position)
+        {
+            window_data->cursor_pos = position;
+            window_data->cursor_pos_known = true;
+        }
+
+        void on_cursor_motion(X11WindowData *window_data, acul::point2D<i32> position)
+        {
+            track_cursor_pos(window_data, position);
+            input_cursor_pos(window_data, position);
         }
 
         void set_cursor_position(WindowData *window_data, acul::point2D<i32> position)
@@ -563,7 +584,8 @@ namespace awin
             xlib.XTranslateCoordinates(g_ctx->display, xd->window, g_ctx->root, position.x, position.y, &abs_pos.x,
                                        &abs_pos.y, &g_ctx->helper_window);
             xlib.XWarpPointer(g_ctx->display, g_ctx->root, g_ctx->root, 0, 0, 0, 0, abs_pos.x, abs_pos.y);
-            xlib.XFlush(g_ctx->display);
+            flush_requests();
+            track_cursor_pos(xd, position);
         }
 
         // From __os_linux_keys.cpp
@@ -594,6 +616,17 @@ namespace awin
             // todo: make DnD here
         }
 
+        // Check the _NET_WM_STATE atoms for a maximized state, Xlib returns them as longs and XCB as 32 bit values
+        template <typename T>
+        static bool has_maximized_state(const T *states, unsigned long count)
+        {
+            for (unsigned long i = 0; i < count; i++)
+                if (states[i] == g_ctx->wm.NET_WM_STATE_MAXIMIZED_VERT ||
+                    states[i] == g_ctx->wm.NET_WM_STATE_MAXIMIZED_HORZ)
+                    return true;
+            return false;
+        }
+
         bool is_window_maximized(X11WindowData *window_data)
         {
             Atom *states;
@@ -605,19 +638,84 @@ namespace awin
 
             const unsigned long count =
                 get_window_property(window_data->window, g_ctx->wm.NET_WM_STATE, XA_ATOM, (unsigned char **)&states);
+            maximized = has_maximized_state(states, count);
 
-            for (unsigned long i = 0; i < count; i++)
+            if (states) g_ctx->xlib.XFree(states);
+            return maximized;
+        }
+
+        static void update_minimized(X11WindowData *window_data, int state)
+        {
+            if (state != IconicState && state != NormalState) return;
+
+            const bool iconified = (state == IconicState);
+            const bool already = (window_data->flags & WindowFlagBits::minimized);
+            if (iconified == already) return;
+
+            if (iconified)
+                window_data->flags |= WindowFlagBits::minimized;
+            else
+                window_data->flags &= ~WindowFlagBits::minimized;
+            dispatch_event<StateEvent>(g_env->events.minimize, event_id::minimize, window_data->owner, iconified);
+        }
+
+        static void update_maximized(X11WindowData *window_data, bool maximized)
+        {
+            const bool already = (window_data->flags & WindowFlagBits::maximized);
+            if (maximized == already) return;
+
+            if (maximized)
+                window_data->flags |= WindowFlagBits::maximized;
+            else
+                window_data->flags &= ~WindowFlagBits::maximized;
+            dispatch_event<StateEvent>(g_env->events.maximize, event_id::maximize, window_data->owner, maximized);
+        }
+
+        // Request the property through XCB without waiting, the reply is applied by resolve_property_fetches at the
+        // end of the poll so that a window manager changing many windows costs one round trip. Returns false when
+        // XCB is not available and the caller has to read the property itself.
+        static bool fetch_property_async(X11WindowData *window_data, Atom property, Atom type, u32 length)
+        {
+            auto &xcb = g_ctx->xlib.xcb;
+            if (!g_ctx->xcb_connection || !xcb.xcb_get_property || !xcb.xcb_get_property_reply ||
+                !xcb.xcb_get_property_value)
+                return false;
+            const auto cookie = xcb.xcb_get_property(g_ctx->xcb_connection, 0, (xcb_window_t)window_data->window,
+                                                     (xcb_atom_t)property, (xcb_atom_t)type, 0, length);
+            g_ctx->property_fetches.push_back({window_data->window, property, cookie});
+            return true;
+        }
+
+        static void resolve_property_fetches()
+        {
+            if (g_ctx->property_fetches.empty()) return;
+
+            // Taken out first, listeners of the state events may poll again
+            acul::vector<PropertyFetch> fetches = std::move(g_ctx->property_fetches);
+            g_ctx->property_fetches.clear();
+
+            auto &xcb = g_ctx->xlib.xcb;
+            for (const auto &fetch : fetches)
             {
-                if (states[i] == g_ctx->wm.NET_WM_STATE_MAXIMIZED_VERT ||
-                    states[i] == g_ctx->wm.NET_WM_STATE_MAXIMIZED_HORZ)
+                xcb_generic_error_t *error = nullptr;
+                xcb_get_property_reply_t *reply =
+                    xcb.xcb_get_property_reply(g_ctx->xcb_connection, fetch.cookie, &error);
+                free(error);
+
+                // The window may have been destroyed since the request
+                X11WindowData *window_data = nullptr;
+                if (reply && g_ctx->xlib.XFindContext(g_ctx->display, fetch.window, g_ctx->context,
+                                                      (XPointer *)&window_data) == 0)
                 {
-                    maximized = true;
-                    break;
+                    const auto *values = static_cast<const u32 *>(xcb.xcb_get_property_value(reply));
+                    const u32 count = reply->format == 32 ? reply->value_len : 0;
+                    if (fetch.property == g_ctx->wm.WM_STATE)
+                        update_minimized(window_data, count >= 2 ? (int)values[0] : WithdrawnState);
+                    else
+                        update_maximized(window_data, has_maximized_state(values, count));
                 }
+                free(reply);
             }
-
-            if (states) g_ctx->xlib.XFree(states);
-            return maximized;
         }
 
         void toogle_rid(bool enable)
@@ -639,7 +737,7 @@ namespace awin
             em.mask = mask;
 
             g_ctx->xlib.xi.XISelectEvents(g_ctx->display, g_ctx->root, &em, 1);
-            g_ctx->xlib.XFlush(g_ctx->display);
+            flush_requests();
         }
 
         inline bool is_raw_event(XEvent *event)
@@ -650,28 +748,55 @@ namespace awin
                    x11.XGetEventData(g_ctx->display, &event->xcookie);
         }
 
-        // Process the specified X event
-        static void process_event(XEvent *event)
+        // Get the server timestamp of the specified X event, 0 for events without one
+        static u32 get_event_time(const XEvent *event)
+        {
+            switch (event->type)
+            {
+                case KeyPress:
+                case KeyRelease:
+                    return (u32)event->xkey.time;
+                case ButtonPress:
+                case ButtonRelease:
+                    return (u32)event->xbutton.time;
+                case MotionNotify:
+                    return (u32)event->xmotion.time;
+                case EnterNotify:
+                case LeaveNotify:
+                    return (u32)event->xcrossing.time;
+                case PropertyNotify:
+                    return (u32)event->xproperty.time;
+                default:
+                    return 0;
+            }
+        }
+
+        void process_event(XEvent *event)
         {
             auto &xlib = g_ctx->xlib;
             unsigned int keycode = 0;
             Bool filtered = False;
+            EventTimeScope time_scope(get_event_time(event));
 
             if (event->type == GenericEvent && is_raw_event(event))
             {
                 XIRawEvent *raw = (XIRawEvent *)event->xcookie.data;
-                acul::point2D<i32> delta{0, 0};
+                g_env->server_time = (u32)raw->time;
+                acul::point2D<f64> delta{0.0, 0.0};
                 int idx = 0;
                 if (XIMaskIsSet(raw->valuators.mask, 0)) delta.x = raw->raw_values[idx++];
                 if (XIMaskIsSet(raw->valuators.mask, 1)) delta.y = raw->raw_values[idx++];
-                if (g_ctx->focused_window)
-                    acul::events::dispatch_event_group<PosEvent>(g_env->events.mouse_move_delta,
-                                                                 event_id::mouse_move_delta,
-                                                                 g_ctx->focused_window->owner, delta);
+                if (g_ctx->focused_window) input_cursor_delta(g_ctx->focused_window, delta);
                 xlib.XFreeEventData(g_ctx->display, &event->xcookie);
                 return;
             }
 
+            if (xlib.shm.init && event->type == xlib.shm.event_base + ShmCompletion)
+            {
+                on_shm_completion((XShmCompletionEvent *)event);
+                return;
+            }
+
             // HACK: Save scancode as some IMs clear the field in XFilterEvent
             if (event->type == KeyPress || event->type == KeyRelease) keycode = event->xkey.keycode;
             filtered = xlib.XFilterEvent(event, None);
@@ -710,15 +835,16 @@ namespace awin
                     on_key_release(event, keycode, window_data);
                     return;
                 case ButtonPress:
+                    track_cursor_pos(window_data, {event->xbutton.x, event->xbutton.y});
                     on_btn_press(event, window_data);
                     return;
                 case ButtonRelease:
+                    track_cursor_pos(window_data, {event->xbutton.x, event->xbutton.y});
                     on_btn_release(event, window_data);
                     return;
                 case EnterNotify:
                 {
-                    acul::events::dispatch_event_group<MouseEnterEvent>(g_env->events.mouse_enter, window_data->owner,
-                                                                        true);
+                    input_mouse_enter(window_data, true);
 
                     if (!window_data->is_cursor_hidden)
                     {
@@ -727,32 +853,27 @@ namespace awin
                         else if (platform::g_env->default_cursor.valid())
                             platform::g_env->default_cursor.assign(window_data->owner);
                     }
-                    acul::point2D dim{event->xcrossing.x, event->xcrossing.y};
-                    acul::events::dispatch_event_group<PosEvent>(g_env->events.mouse_move, event_id::mouse_move,
-                                                                 window_data->owner, dim);
+                    track_cursor_pos(window_data, {event->xcrossing.x, event->xcrossing.y});
+                    input_cursor_pos(window_data, {event->xcrossing.x, event->xcrossing.y});
                     return;
                 }
                 case LeaveNotify:
                 {
-                    acul::events::dispatch_event_group<MouseEnterEvent>(g_env->events.mouse_enter, window_data->owner,
-                                                                        false);
+                    // Outside the window the pointer is only reported while grabbed, ask the server until it returns
+                    window_data->cursor_pos_known = false;
+                    input_mouse_enter(window_data, false);
                     return;
                 }
                 case MotionNotify:
-                {
-                    acul::point2D pos{event->xmotion.x, event->xmotion.y};
-                    acul::events::dispatch_event_group<PosEvent>(g_env->events.mouse_move, event_id::mouse_move,
-                                                                 window_data->owner, pos);
+                    on_cursor_motion(window_data, {event->xmotion.x, event->xmotion.y});
                     return;
-                }
                 case ConfigureNotify:
                 {
                     acul::point2D<i32> dimenstions(event->xconfigure.width, event->xconfigure.height);
                     if (dimenstions != window_data->dimenstions)
                     {
                         window_data->dimenstions = dimenstions;
-                        acul::events::dispatch_event_group<PosEvent>(g_env->events.resize, event_id::resize,
-                                                                     window_data->owner, window_data->dimenstions);
+                        input_window_resize(window_data, dimenstions);
                     }
                     acul::point2D<i32> pos(event->xconfigure.x, event->xconfigure.y);
 
@@ -761,7 +882,7 @@ namespace awin
                     //       the position into root (screen) coordinates
                     if (!event->xany.send_event && window_data->parent != g_ctx->root)
                     {
-                        grab_error_handler();
+                        grab_error_handler("window position translation");
 
                         XID dummy;
                         xlib.XTranslateCoordinates(g_ctx->display, window_data->parent, g_ctx->root, pos.x, pos.y,
@@ -774,8 +895,8 @@ namespace awin
                     if (window_data->window_pos != pos)
                     {
                         window_data->window_pos = pos;
-                        acul::events::dispatch_event_group<PosEvent>(g_env->events.move, event_id::move,
-                                                                     window_data->owner, pos);
+                        window_data->cursor_pos_known = false; // Window relative, stale after a move
+                        dispatch_event<PosEvent>(g_env->events.move, event_id::move, window_data->owner, pos);
                     }
                     return;
                 }
@@ -795,7 +916,7 @@ namespace awin
                     if (window_data->ic) xlib.XSetICFocus(window_data->ic);
 
                     window_data->focused = true;
-                    acul::events::dispatch_event_group<FocusEvent>(g_env->events.focus, window_data->owner, true);
+                    input_focus(window_data, true);
                     toogle_rid(true);
                     g_ctx->focused_window = window_data;
                     return;
@@ -812,48 +933,32 @@ namespace awin
                     if (window_data->ic) xlib.XUnsetICFocus(window_data->ic);
 
                     window_data->focused = false;
-                    acul::events::dispatch_event_group<FocusEvent>(g_env->events.focus, window_data->owner, false);
+                    input_focus(window_data, false);
                     toogle_rid(false);
                     return;
                 }
                 case PropertyNotify:
                 {
+                    if (event->xproperty.atom == g_ctx->wm.NET_WM_NAME)
+                    {
+                        // Our own writes are already cached, anything else is refetched on the next request
+                        if (event->xproperty.state == PropertyNewValue && window_data->own_title_writes > 0)
+                            --window_data->own_title_writes;
+                        else
+                            window_data->title_known = false;
+                        return;
+                    }
                     if (event->xproperty.state != PropertyNewValue) return;
 
                     if (event->xproperty.atom == g_ctx->wm.WM_STATE)
                     {
-                        const int state = get_window_state(window_data);
-                        if (state != IconicState && state != NormalState) return;
-
-                        const bool iconified = (state == IconicState);
-                        const bool already = (window_data->flags & WindowFlagBits::minimized);
-
-                        if (iconified != already)
-                        {
-                            if (iconified)
-                                window_data->flags |= WindowFlagBits::minimized;
-                            else
-                                window_data->flags &= ~WindowFlagBits::minimized;
-
-                            acul::events::dispatch_event_group<StateEvent>(g_env->events.minimize, event_id::minimize,
-                                                                           window_data->owner, iconified);
-                        }
+                        if (!fetch_property_async(window_data, g_ctx->wm.WM_STATE, g_ctx->wm.WM_STATE, 2))
+                            update_minimized(window_data, get_window_state(window_data));
                     }
                     else if (event->xproperty.atom == g_ctx->wm.NET_WM_STATE)
                     {
-                        const bool maximized = is_window_maximized(window_data);
-                        const bool already = (window_data->flags & WindowFlagBits::maximized);
-
-                        if (maximized != already)
-                        {
-                            if (maximized)
-                                window_data->flags |= WindowFlagBits::maximized;
-                            else
-                                window_data->flags &= ~WindowFlagBits::maximized;
-
-                            acul::events::dispatch_event_group<StateEvent>(g_env->events.maximize, event_id::maximize,
-                                                                           window_data->owner, maximized);
-                        }
+                        if (!fetch_property_async(window_data, g_ctx->wm.NET_WM_STATE, XA_ATOM, 64))
+                            update_maximized(window_data, is_window_maximized(window_data));
                     }
 
                     return;
@@ -966,9 +1071,11 @@ namespace awin
             return {attribs.width, attribs.height};
         }
 
+        // Kept up to date from ConfigureNotify
         acul::point2D<i32> get_window_size(const Window &window)
         {
-            return get_window_size(native_access::get_x11_window_handle(window));
+            ++g_ctx->round_trips_avoided;
+            return get_window_data(window)->dimenstions;
         }
 
         bool create_window(WindowData *window_data, const acul::string &title, i32 width, i32 height, WindowFlags flags)
@@ -985,7 +1092,7 @@ namespace awin
             wa.event_mask = StructureNotifyMask | KeyPressMask | KeyReleaseMask | PointerMotionMask | ButtonPressMask |
                             ButtonReleaseMask | ExposureMask | FocusChangeMask | VisibilityChangeMask |
                             EnterWindowMask | LeaveWindowMask | PropertyChangeMask;
-            grab_error_handler();
+            grab_error_handler("window creation");
             x11_data->parent = g_ctx->root;
             x11_data->window = xlib.XCreateWindow(g_ctx->display, g_ctx->root, 0, 0, width, height,
                                                   0,     // Border width
@@ -1068,16 +1175,14 @@ namespace awin
                 x11_data->colormap = (Colormap)0;
             }
 
-            xlib.XFlush(g_ctx->display);
+            flush_requests();
         }
 
+        // Kept up to date from ConfigureNotify
         acul::point2D<i32> get_window_position(WindowData *window)
         {
-            auto *x11_data = (X11WindowData *)window;
-            ::Window dummy;
-            acul::point2D<i32> r;
-            g_ctx->xlib.XTranslateCoordinates(g_ctx->display, x11_data->window, g_ctx->root, 0, 0, &r.x, &r.y, &dummy);
-            return r;
+            ++g_ctx->round_trips_avoided;
+            return ((X11WindowData *)window)->window_pos;
         }
 
         void set_window_position(WindowData *window, acul::point2D<i32> position)
@@ -1100,7 +1205,7 @@ namespace awin
                 xlib.XFree(hints);
             }
             xlib.XMoveWindow(g_ctx->display, x11_data->window, position.x, position.y);
-            xlib.XFlush(g_ctx->display);
+            flush_requests();
         }
 
         MonitorInfo get_primary_monitor_info()
@@ -1143,7 +1248,7 @@ namespace awin
             auto *x11_data = (X11WindowData *)window;
             xlib.XMoveResizeWindow(g_ctx->display, x11_data->window, center.x, center.y, window->dimenstions.x,
                                    window->dimenstions.y);
-            xlib.XFlush(g_ctx->display);
+            flush_requests();
         }
 
         static void update_normal_hints(X11WindowData *window_data, acul::point2D<i32> dim)
@@ -1180,7 +1285,7 @@ namespace awin
         void update_resize_limit(WindowData *window)
         {
             update_normal_hints((X11WindowData *)window, window->dimenstions);
-            g_ctx->xlib.XFlush(g_ctx->display);
+            flush_requests();
         }
 
         void minimize_window(WindowData *window)
@@ -1188,7 +1293,7 @@ namespace awin
             auto *x11_data = (X11WindowData *)window;
             auto &xlib = g_ctx->xlib;
             xlib.XIconifyWindow(g_ctx->display, x11_data->window, g_ctx->screen);
-            xlib.XFlush(g_ctx->display);
+            flush_requests();
         }
 
         void maximize_window(WindowData *window)
@@ -1228,24 +1333,49 @@ namespace awin
             else
                 send_event_to_wm(x11_data, g_ctx->wm.NET_WM_STATE, _NET_WM_STATE_ADD,
                                  g_ctx->wm.NET_WM_STATE_MAXIMIZED_VERT, g_ctx->wm.NET_WM_STATE_MAXIMIZED_HORZ, 1, 0);
-            xlib.XFlush(g_ctx->display);
+            flush_requests();
         }
 
         void poll_events()
         {
-            drain_empty_events();
+            drain_wake_event(g_env->wake);
             auto &xlib = g_ctx->xlib;
 
-            xlib.XPending(g_ctx->display);
-
-            while (QLength(g_ctx->display))
+            // Events read from the socket while waiting for the property replies are queued by then, they are
+            // processed before returning so that the event descriptor does not sleep with input pending
+            for (;;)
             {
-                XEvent event;
-                xlib.XNextEvent(g_ctx->display, &event);
-                process_event(&event);
+                if (g_ctx->xcb_owns_events)
+                {
+                    xlib.XFlush(g_ctx->display);
+                    process_xcb_events();
+                }
+                else
+                {
+                    xlib.XPending(g_ctx->display);
+
+                    while (QLength(g_ctx->display))
+                    {
+                        XEvent event;
+                        xlib.XNextEvent(g_ctx->display, &event);
+                        process_event(&event);
+                    }
+                }
+                if (g_ctx->property_fetches.empty()) break;
+                resolve_property_fetches();
             }
 
             xlib.XFlush(g_ctx->display);
+            g_ctx->flush_pending = false;
+        }
+
+        void begin_batch() { ++g_ctx->batch_depth; }
+
+        void end_batch()
+        {
+            if (g_ctx->batch_depth == 0 || --g_ctx->batch_depth > 0 || !g_ctx->flush_pending) return;
+            g_ctx->flush_pending = false;
+            g_ctx->xlib.XFlush(g_ctx->display);
         }
 
         void wait_events()
@@ -1254,20 +1384,16 @@ namespace awin
             poll_events();
         }
 
-        void wait_events_timeout()
+        void wait_events_timeout(f64 timeout)
         {
-            wait_for_any_event(g_env->timeout > WINDOW_TIMEOUT_INF ? &g_env->timeout : NULL);
+            wait_for_any_event(&timeout);
             poll_events();
         }
 
-        void push_empty_event()
+        void get_event_fds(acul::vector<int> &fds)
         {
-            for (;;)
-            {
-                const char byte = 0;
-                const ssize_t result = write(g_ctx->empty_pipe[1], &byte, 1);
-                if (result == 1 || (result == -1 && errno != EINTR)) break;
-            }
+            fds.push_back(ConnectionNumber(g_ctx->display));
+            fds.push_back(g_env->wake.fd);
         }
 
         f32 get_dpi(WindowData *) { return g_ctx->dpi.x; }
@@ -1305,7 +1431,7 @@ namespace awin
             xlib.XChangeProperty(g_ctx->display, window->window, g_ctx->wm.NET_WM_ICON, XA_CARDINAL, 32,
                                  PropModeReplace, reinterpret_cast<const unsigned char *>(buf.data()),
                                  static_cast<int>(buf.size()));
-            xlib.XFlush(g_ctx->display);
+            flush_requests();
         }
 
         ::Cursor load_system_cursor(Display *display, const char *name, unsigned int fallback_shape)
@@ -1358,7 +1484,7 @@ namespace awin
                 xlib.XDefineCursor(g_ctx->display, x11_data->window, x11_cursor->handle);
             else
                 xlib.XUndefineCursor(g_ctx->display, x11_data->window);
-            xlib.XFlush(g_ctx->display);
+            flush_requests();
         }
 
         void destroy_cursor(Cursor::Platform *cursor)
@@ -1382,7 +1508,7 @@ namespace awin
             auto *x11_data = (X11WindowData *)window_data;
             if (window_data->is_cursor_hidden) return;
             g_ctx->xlib.XDefineCursor(g_ctx->display, x11_data->window, g_ctx->hidden_cursor.handle);
-            g_ctx->xlib.XFlush(g_ctx->display);
+            flush_requests();
             window_data->is_cursor_hidden = true;
         }
 
@@ -1402,4 +1528,9 @@ namespace awin
     {
         return static_cast<platform::x11::X11WindowData *>(get_window_data(window))->window;
     }
+
+    u64 native_access::get_x11_round_trips_avoided()
+    {
+        return platform::x11::g_ctx ? platform::x11::g_ctx->round_trips_avoided : 0;
+    }
 } // namespace awin
\ No newline at end of file
@@ -0,0 +1,259 @@
+#include <X11/XKBlib.h>
+#include <bit>
+#include <cstdlib>
+#include <cstring>
+#include "platform.hpp"
+#include "window.hpp"
+
+// Optional XCB event path. When XCB owns the event queue the events are read in batches with
+// xcb_poll_for_queued_event, the frequent pointer events are decoded in place and the rest is converted to its Xlib
+// form for process_event. The helpers at the end give the Xlib queue functions used outside the event loop the
+// same behavior in both modes.
+namespace awin::platform::x11
+{
+    bool init_xcb_events()
+    {
+        auto &xcb = g_ctx->xlib.xcb;
+        if (!g_ctx->xcb_connection || !xcb.XSetEventQueueOwner || !xcb.xcb_poll_for_event ||
+            !xcb.xcb_poll_for_queued_event || !g_ctx->xlib.XESetWireToEvent)
+        {
+            AWIN_LOG_WARN("XCB event reading is not available, using the Xlib event queue");
+            return false;
+        }
+        xcb.XSetEventQueueOwner(g_ctx->display, XCBOwnsEventQueue);
+        g_ctx->xcb_owns_events = true;
+        AWIN_LOG_INFO("Reading X11 events through XCB, input methods are disabled");
+        return true;
+    }
+
+    void release_xcb_events()
+    {
+        for (auto *event : g_ctx->xcb_events) free(event);
+        g_ctx->xcb_events.clear();
+        g_ctx->xcb_head = 0;
+    }
+
+    // Append the events that arrived on the connection to the pending list. The socket is read once, the rest is
+    // taken from the XCB queue without further reads.
+    static void read_xcb_events()
+    {
+        auto &xcb = g_ctx->xlib.xcb;
+        for (auto *event = xcb.xcb_poll_for_event(g_ctx->xcb_connection); event;
+             event = xcb.xcb_poll_for_queued_event(g_ctx->xcb_connection))
+            g_ctx->xcb_events.push_back(event);
+    }
+
+    // Widen the 32 bit sequence number XCB keeps for the event to an Xlib serial
+    static unsigned long widen_sequence(u32 sequence)
+    {
+        return (LastKnownRequestProcessed(g_ctx->display) & ~0xFFFFFFFFUL) | sequence;
+    }
+
+    // Convert a wire event to its Xlib form with the converter Xlib has registered for the event type
+    static bool to_xevent(xcb_generic_event_t *event, XEvent *out)
+    {
+        const int type = event->response_type & 0x7F;
+        if (type < KeyPress || type == XCB_GE_GENERIC) return false; // Errors and cookie events
+        XWireToEventProc &proc = g_ctx->wire_to_event[type];
+        if (!proc)
+        {
+            auto &xlib = g_ctx->xlib;
+            proc = xlib.XESetWireToEvent(g_ctx->display, type, nullptr);
+            xlib.XESetWireToEvent(g_ctx->display, type, proc);
+        }
+
+        // The converter widens the event sequence against the last request Xlib has read and stores the result as
+        // both. Events are converted after the batch was read, so a round trip made for an earlier event may have
+        // moved that counter past this one, which Xlib reports as a lost sequence and follows by moving it back.
+        // The converter sees the serial of the event instead and the counter is restored afterwards.
+        auto *display = (_XPrivDisplay)g_ctx->display;
+        const unsigned long last_request_read = display->last_request_read;
+        const unsigned long serial = widen_sequence(event->full_sequence);
+        display->last_request_read = serial;
+        *out = {};
+        const bool converted = proc(g_ctx->display, out, event);
+        display->last_request_read = last_request_read;
+        if (!converted) return false;
+        out->xany.serial = serial;
+        return true;
+    }
+
+    static void process_error(const xcb_generic_error_t *error)
+    {
+        XErrorEvent event = {};
+        event.type = 0;
+        event.display = g_ctx->display;
+        event.resourceid = error->resource_id;
+        event.serial = widen_sequence(error->full_sequence);
+        event.error_code = error->error_code;
+        event.request_code = error->major_code;
+        event.minor_code = error->minor_code;
+        error_handler(g_ctx->display, &event);
+    }
+
+    void process_xcb_errors()
+    {
+        read_xcb_events();
+        auto &events = g_ctx->xcb_events;
+        for (size_t i = g_ctx->xcb_head; i < events.size(); ++i)
+        {
+            if (!events[i] || events[i]->response_type != 0) continue;
+            process_error(reinterpret_cast<xcb_generic_error_t *>(events[i]));
+            free(events[i]);
+            events[i] = nullptr;
+        }
+    }
+
+    static void process_motion(const xcb_motion_notify_event_t *event)
+    {
+        X11WindowData *window_data = nullptr;
+        if (g_ctx->xlib.XFindContext(g_ctx->display, event->event, g_ctx->context, (XPointer *)&window_data) != 0)
+            return;
+        EventTimeScope time_scope(event->time);
+        on_cursor_motion(window_data, {event->event_x, event->event_y});
+    }
+
+    // XI2 raw motion on the wire: the xXIRawEvent header, the valuator mask, then the accelerated and the raw values
+    // of the set valuators as FP3232. XCB inserts the full sequence number after the 32 byte header.
+    static void process_raw_motion(const xcb_ge_generic_event_t *event)
+    {
+        const u8 *data = reinterpret_cast<const u8 *>(event);
+        u32 time;
+        u16 mask_len;
+        memcpy(&time, data + 12, sizeof(time));
+        memcpy(&mask_len, data + 22, sizeof(mask_len));
+        const u8 *mask = data + 36;
+
+        int count = 0;
+        for (u16 i = 0; i < mask_len; ++i)
+        {
+            u32 bits;
+            memcpy(&bits, mask + i * 4, sizeof(bits));
+            count += std::popcount(bits);
+        }
+        const u8 *raw_values = mask + mask_len * 4 + count * 8;
+        auto raw_value = [raw_values](int index) {
+            i32 integral;
+            u32 frac;
+            memcpy(&integral, raw_values + index * 8, sizeof(integral));
+            memcpy(&frac, raw_values + index * 8 + 4, sizeof(frac));
+            return integral + frac / 4294967296.0;
+        };
+
+        acul::point2D<f64> delta{0.0, 0.0};
+        int idx = 0;
+        if (mask_len > 0 && (mask[0] & 0x1)) delta.x = raw_value(idx++);
+        if (mask_len > 0 && (mask[0] & 0x2)) delta.y = raw_value(idx++);
+        EventTimeScope time_scope(time);
+        if (g_ctx->focused_window) input_cursor_delta(g_ctx->focused_window, delta);
+    }
+
+    // xkbStateNotify on the wire: the XKB event type follows the response type, the locked and latched group is at
+    // byte 13 and the changed components at byte 26
+    static void process_xkb_event(const xcb_generic_event_t *event)
+    {
+        const u8 *data = reinterpret_cast<const u8 *>(event);
+        if (data[1] != XkbStateNotify) return;
+        u16 changed;
+        memcpy(&changed, data + 26, sizeof(changed));
+        if (changed & XkbGroupStateMask) g_ctx->xlib.xkb.group = data[13];
+    }
+
+    static void process_xcb_event(xcb_generic_event_t *event)
+    {
+        auto &xlib = g_ctx->xlib;
+        const int type = event->response_type & 0x7F;
+        if (type == 0)
+            process_error(reinterpret_cast<xcb_generic_error_t *>(event));
+        else if (type == XCB_MOTION_NOTIFY)
+            process_motion(reinterpret_cast<xcb_motion_notify_event_t *>(event));
+        else if (type == XCB_GE_GENERIC)
+        {
+            auto *ge = reinterpret_cast<xcb_ge_generic_event_t *>(event);
+            if (xlib.xi.init && ge->extension == xlib.xi.major_op_code && ge->event_type == XI_RawMotion)
+                process_raw_motion(ge);
+        }
+        else if (xlib.xkb.init && type == xlib.xkb.event_base + XkbEventCode)
+            process_xkb_event(event);
+        else
+        {
+            XEvent xevent;
+            if (to_xevent(event, &xevent)) process_event(&xevent);
+        }
+    }
+
+    void process_xcb_events()
+    {
+        read_xcb_events();
+
+        // Listeners may read more events, for example while waiting for the clipboard. Those are appended to the
+        // list and processed by this loop as well.
+        auto &events = g_ctx->xcb_events;
+        while (g_ctx->xcb_head < events.size())
+        {
+            xcb_generic_event_t *event = events[g_ctx->xcb_head];
+            events[g_ctx->xcb_head++] = nullptr;
+            if (!event) continue;
+            process_xcb_event(event);
+            free(event);
+        }
+        events.clear();
+        g_ctx->xcb_head = 0;
+    }
+
+    bool has_queued_events()
+    {
+        if (!g_ctx->xcb_owns_events) return g_ctx->xlib.XPending(g_ctx->display);
+        g_ctx->xlib.XFlush(g_ctx->display);
+        read_xcb_events();
+        for (size_t i = g_ctx->xcb_head; i < g_ctx->xcb_events.size(); ++i)
+            if (g_ctx->xcb_events[i]) return true;
+        return false;
+    }
+
+    bool check_if_event(XEvent *event, Bool (*predicate)(Display *, XEvent *, XPointer), XPointer arg)
+    {
+        if (!g_ctx->xcb_owns_events) return g_ctx->xlib.XCheckIfEvent(g_ctx->display, event, predicate, arg);
+        g_ctx->xlib.XFlush(g_ctx->display);
+        read_xcb_events();
+        auto &events = g_ctx->xcb_events;
+        for (size_t i = g_ctx->xcb_head; i < events.size(); ++i)
+        {
+            if (!events[i] || !to_xevent(events[i], event) || !predicate(g_ctx->display, event, arg)) continue;
+            free(events[i]);
+            events[i] = nullptr;
+            return true;
+        }
+        return false;
+    }
+
+    bool check_typed_window_event(::Window window, int type, XEvent *event)
+    {
+        if (!g_ctx->xcb_owns_events) return g_ctx->xlib.XCheckTypedWindowEvent(g_ctx->display, window, type, event);
+        struct Match
+        {
+            ::Window window;
+            int type;
+        } match{window, type};
+        auto matches = [](Display *, XEvent *e, XPointer arg) -> Bool {
+            auto *m = reinterpret_cast<Match *>(arg);
+            return e->type == m->type && e->xany.window == m->window;
+        };
+        return check_if_event(event, matches, reinterpret_cast<XPointer>(&match));
+    }
+
+    bool peek_queued_event(XEvent *event)
+    {
+        auto &xlib = g_ctx->xlib;
+        if (!g_ctx->xcb_owns_events)
+        {
+            if (!xlib.XEventsQueued(g_ctx->display, QueuedAfterReading)) return false;
+            xlib.XPeekEvent(g_ctx->display, event);
+            return true;
+        }
+        read_xcb_events();
+        for (size_t i = g_ctx->xcb_head; i < g_ctx->xcb_events.size(); ++i)
+            if (g_ctx->xcb_events[i]) return to_xevent(g_ctx->xcb_events[i], event);
+        return false;
+    }
+} // namespace awin::platform::x11
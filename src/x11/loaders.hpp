@@ -7,6 +7,7 @@
 #include <X11/Xresource.h>
 #include <X11/Xutil.h>
 #include <X11/extensions/XInput2.h>
+#include <X11/extensions/XShm.h>
 #include <X11/extensions/Xinerama.h>
 #include <X11/extensions/Xrandr.h>
 #include <X11/extensions/shape.h>
@@ -26,6 +27,9 @@ typedef Status (*PFN_XCloseIM)(XIM);
 typedef int (*PFN_XConvertSelection)(Display *, Atom, Atom, Atom, XID, Time);
 typedef Colormap (*PFN_XCreateColormap)(Display *, XID, Visual *, int);
 typedef ::Cursor (*PFN_XCreateFontCursor)(Display *, unsigned int);
+typedef GC (*PFN_XCreateGC)(Display *, Drawable, unsigned long, XGCValues *);
+typedef XImage *(*PFN_XCreateImage)(Display *, Visual *, unsigned int, int, int, char *, unsigned int, unsigned int,
+                                    int, int);
 typedef XIC (*PFN_XCreateIC)(XIM, ...);
 typedef Region (*PFN_XCreateRegion)(void);
 typedef XID (*PFN_XCreateWindow)(Display *, XID, int, int, unsigned int, unsigned int, unsigned int, int, unsigned int,
@@ -37,11 +41,14 @@ typedef void (*PFN_XDestroyIC)(XIC);
 typedef int (*PFN_XDestroyRegion)(Region);
 typedef int (*PFN_XDestroyWindow)(Display *, XID);
 typedef int (*PFN_XDisplayKeycodes)(Display *, int *, int *);
+typedef Bool (*XWireToEventProc)(Display *, XEvent *, void *);
+typedef XWireToEventProc (*PFN_XESetWireToEvent)(Display *, int, XWireToEventProc);
 typedef int (*PFN_XEventsQueued)(Display *, int);
 typedef Bool (*PFN_XFilterEvent)(XEvent *, XID);
 typedef int (*PFN_XFindContext)(Display *, XID, XContext, XPointer *);
 typedef int (*PFN_XFlush)(Display *);
 typedef int (*PFN_XFree)(void *);
+typedef int (*PFN_XFreeGC)(Display *, GC);
 typedef char *(*PFN_XGetAtomName)(Display *, Atom);
 typedef int (*PFN_XFreeColormap)(Display *, Colormap);
 typedef int (*PFN_XFreeCursor)(Display *, ::Cursor);
@@ -63,6 +70,7 @@ typedef int (*PFN_XGrabPointer)(Display *, XID, Bool, unsigned int, int, int, XI
 typedef Status (*PFN_XIconifyWindow)(Display *, XID, int);
 typedef Status (*PFN_XInitThreads)(void);
 typedef Atom (*PFN_XInternAtom)(Display *, const char *, Bool);
+typedef Status (*PFN_XInternAtoms)(Display *, char **, int, Bool, Atom *);
 typedef int (*PFN_XLookupString)(XKeyEvent *, char *, int, KeySym *, XComposeStatus *);
 typedef int (*PFN_Xutf8LookupString)(XIC, XKeyPressedEvent *, char *, int, KeySym *, Status *);
 typedef void (*PFN_Xutf8SetWMProperties)(Display *, XID, const char *, const char *, char **, int, XSizeHints *,
@@ -75,6 +83,7 @@ typedef int (*PFN_XNextEvent)(Display *, XEvent *);
 typedef Display *(*PFN_XOpenDisplay)(const char *);
 typedef XIM (*PFN_XOpenIM)(Display *, XrmDatabase *, char *, char *);
 typedef int (*PFN_XPeekEvent)(Display *, XEvent *);
+typedef int (*PFN_XPutImage)(Display *, Drawable, GC, XImage *, int, int, int, int, unsigned int, unsigned int);
 typedef int (*PFN_XPending)(Display *);
 typedef void (*PFN_XrmDestroyDatabase)(XrmDatabase);
 typedef Bool (*PFN_XrmGetResource)(XrmDatabase, const char *, const char *, char **, XrmValue *);
@@ -143,6 +152,16 @@ typedef Status (*PFN_XRRSetCrtcConfig)(Display *, XRRScreenResources *, RRCrtc,
 typedef void (*PFN_XRRSetCrtcGamma)(Display *, RRCrtc, XRRCrtcGamma *);
 typedef int (*PFN_XRRUpdateConfiguration)(XEvent *);
 
+// MIT-SHM
+typedef Bool (*PFN_XShmQueryExtension)(Display *);
+typedef int (*PFN_XShmGetEventBase)(Display *);
+typedef XImage *(*PFN_XShmCreateImage)(Display *, Visual *, unsigned int, int, char *, XShmSegmentInfo *,
+                                       unsigned int, unsigned int);
+typedef Bool (*PFN_XShmAttach)(Display *, XShmSegmentInfo *);
+typedef Bool (*PFN_XShmDetach)(Display *, XShmSegmentInfo *);
+typedef Bool (*PFN_XShmPutImage)(Display *, Drawable, GC, XImage *, int, int, int, int, unsigned int, unsigned int,
+                                 Bool);
+
 // X Cursor
 typedef XcursorImage *(*PFN_XcursorImageCreate)(int, int);
 typedef void (*PFN_XcursorImageDestroy)(XcursorImage *);
@@ -150,7 +169,20 @@ typedef ::Cursor (*PFN_XcursorImageLoadCursor)(Display *, const XcursorImage *);
 typedef ::Cursor (*PFN_XcursorLibraryLoadCursor)(Display *, const char *);
 
 // XCB
+enum XEventQueueOwner // From X11/Xlib-xcb.h
+{
+    XlibOwnsEventQueue = 0,
+    XCBOwnsEventQueue
+};
 typedef xcb_connection_t *(*PFN_XGetXCBConnection)(Display *);
+typedef void (*PFN_XSetEventQueueOwner)(Display *, enum XEventQueueOwner);
+typedef xcb_generic_event_t *(*PFN_xcb_poll_for_event)(xcb_connection_t *);
+typedef xcb_generic_event_t *(*PFN_xcb_poll_for_queued_event)(xcb_connection_t *);
+typedef xcb_get_property_cookie_t (*PFN_xcb_get_property)(xcb_connection_t *, uint8_t, xcb_window_t, xcb_atom_t,
+                                                          xcb_atom_t, uint32_t, uint32_t);
+typedef xcb_get_property_reply_t *(*PFN_xcb_get_property_reply)(xcb_connection_t *, xcb_get_property_cookie_t,
+                                                                 xcb_generic_error_t **);
+typedef void *(*PFN_xcb_get_property_value)(const xcb_get_property_reply_t *);
 
 // XRender
 typedef Bool (*PFN_XRenderQueryExtension)(Display *, int *, int *);
@@ -178,6 +210,8 @@ namespace awin
                 PFN_XConvertSelection XConvertSelection = nullptr;
                 PFN_XCreateColormap XCreateColormap = nullptr;
                 PFN_XCreateFontCursor XCreateFontCursor = nullptr;
+                PFN_XCreateGC XCreateGC = nullptr;
+                PFN_XCreateImage XCreateImage = nullptr;
                 PFN_XCreateIC XCreateIC = nullptr;
                 PFN_XCreateRegion XCreateRegion = nullptr;
                 PFN_XCreateWindow XCreateWindow = nullptr;
@@ -188,11 +222,13 @@ namespace awin
                 PFN_XDestroyRegion XDestroyRegion = nullptr;
                 PFN_XDestroyWindow XDestroyWindow = nullptr;
                 PFN_XDisplayKeycodes XDisplayKeycodes = nullptr;
+                PFN_XESetWireToEvent XESetWireToEvent = nullptr;
                 PFN_XEventsQueued XEventsQueued = nullptr;
                 PFN_XFilterEvent XFilterEvent = nullptr;
                 PFN_XFindContext XFindContext = nullptr;
                 PFN_XFlush XFlush = nullptr;
                 PFN_XFree XFree = nullptr;
+                PFN_XFreeGC XFreeGC = nullptr;
                 PFN_XGetAtomName XGetAtomName = nullptr;
                 PFN_XFreeColormap XFreeColormap = nullptr;
                 PFN_XFreeCursor XFreeCursor = nullptr;
@@ -213,6 +249,7 @@ namespace awin
                 PFN_XIconifyWindow XIconifyWindow = nullptr;
                 PFN_XInitThreads XInitThreads = nullptr;
                 PFN_XInternAtom XInternAtom = nullptr;
+                PFN_XInternAtoms XInternAtoms = nullptr;
                 PFN_XLookupString XLookupString = nullptr;
                 PFN_Xutf8LookupString Xutf8LookupString = nullptr;
                 PFN_Xutf8SetWMProperties Xutf8SetWMProperties = nullptr;
@@ -225,6 +262,7 @@ namespace awin
                 PFN_XOpenIM XOpenIM = nullptr;
                 PFN_XPeekEvent XPeekEvent = nullptr;
                 PFN_XPending XPending = nullptr;
+                PFN_XPutImage XPutImage = nullptr;
                 PFN_XQueryExtension XQueryExtension = nullptr;
                 PFN_XQueryPointer XQueryPointer = nullptr;
                 PFN_XQueryTree XQueryTree = nullptr;
@@ -295,6 +333,21 @@ namespace awin
                 bool load();
             };
 
+            class XShmLoader
+            {
+            public:
+                void *handle = nullptr;
+
+                PFN_XShmQueryExtension XShmQueryExtension = nullptr;
+                PFN_XShmGetEventBase XShmGetEventBase = nullptr;
+                PFN_XShmCreateImage XShmCreateImage = nullptr;
+                PFN_XShmAttach XShmAttach = nullptr;
+                PFN_XShmDetach XShmDetach = nullptr;
+                PFN_XShmPutImage XShmPutImage = nullptr;
+
+                bool load();
+            };
+
             class XCursorLoader
             {
             public:
@@ -314,6 +367,12 @@ namespace awin
                 void *handle = nullptr;
 
                 PFN_XGetXCBConnection XGetXCBConnection = nullptr;
+                PFN_XSetEventQueueOwner XSetEventQueueOwner = nullptr;
+                PFN_xcb_poll_for_event xcb_poll_for_event = nullptr;
+                PFN_xcb_poll_for_queued_event xcb_poll_for_queued_event = nullptr;
+                PFN_xcb_get_property xcb_get_property = nullptr;
+                PFN_xcb_get_property_reply xcb_get_property_reply = nullptr;
+                PFN_xcb_get_property_value xcb_get_property_value = nullptr;
 
                 bool load();
             };
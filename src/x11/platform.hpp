@@ -43,10 +43,15 @@ namespace awin::platform::x11
         int major_op_code;
     };
 
+    struct XShmData : ExtensionData, XShmLoader
+    {
+    };
+
     struct XlibData : XlibLoader
     {
         XKBData xkb;
         XIData xi;
+        XShmData shm;
         XCBData xcb;
         XCursorLoader xcursor;
     };
@@ -99,11 +104,45 @@ namespace awin::platform::x11
         Atom WINDOW_SELECTION;
     };
 
+    // Requests whose errors are reported under a label when they arrive
+    struct ErrorScope
+    {
+        unsigned long first, last; // Sequence numbers of the first and last request
+        const char *what;
+    };
+
+    // Window property read issued through XCB, its reply is handled at the end of the poll
+    struct PropertyFetch
+    {
+        ::Window window;
+        Atom property;
+        xcb_get_property_cookie_t cookie;
+    };
+
     struct X11Cursor final : Cursor::Platform
     {
         ::Cursor handle = 0;
     };
 
+    struct X11SoftwareBuffer
+    {
+        XImage *image;
+        XShmSegmentInfo shm; // shmid is -1 for images sent over the connection
+        u64 presented;       // Frame the buffer was presented as, 0 if never
+        bool busy;           // MIT-SHM image the server has not finished reading
+    };
+
+    struct X11SoftwareSurface final : SoftwareSurface::Platform
+    {
+        ::Window handle;
+        GC gc;
+        Visual *visual;
+        int depth;
+        bool use_shm;
+        acul::point2D<i32> size;
+        acul::vector<X11SoftwareBuffer> buffers;
+    };
+
     struct KeyTraits
     {
         using value_type = uint16_t;
@@ -246,19 +285,33 @@ namespace awin::platform::x11
         bool utf8 = false;
         XIM im;
         acul::point2D<f32> dpi;
-        int empty_pipe[2];
         int error_code;
-        XErrorHandler error_handler = NULL;
+        XErrorHandler error_handler = NULL;    // Handler installed before ours, gets the errors outside the scopes
+        unsigned long error_scope_first = 0;   // First request of the open error scope, 0 if none is open
+        const char *error_scope_what = nullptr;
+        acul::vector<ErrorScope> error_scopes; // Closed scopes whose errors may still arrive
+        u32 batch_depth = 0;                   // Open begin_batch calls
+        bool flush_pending = false;            // Requests held back by the batch
+        xcb_connection_t *xcb_connection = nullptr; // XCB side of the display, when libX11-xcb is available
+        bool xcb_owns_events = false;               // XCB owns the event queue, see InitConfig::xcb_events
+        acul::vector<xcb_generic_event_t *> xcb_events; // Events read from XCB, the taken ones are set to null
+        size_t xcb_head = 0;                            // First unprocessed entry of xcb_events
+        XWireToEventProc wire_to_event[128] = {};       // Xlib converters of the event types, filled on first use
+        acul::vector<PropertyFetch> property_fetches;   // Window state reads waiting for their replies
+        // Software surfaces of the connection, searched for the buffer of a MIT-SHM completion
+        acul::vector<X11SoftwareSurface *> software_surfaces;
         acul::string primary_selection_string;
         WindowData *focused_window = nullptr;
         acul::lut_table<256, KeyTraits> keymap;
         WMAtoms wm;                  // Window manager atoms
         SelectionAtoms select_atoms; // Selection (clipboard) atoms
+        u64 round_trips_avoided = 0; // Getters answered from the state tracked from events
 
         ~Context()
         {
             unload(xlib.xcb.handle);
             unload(xlib.xi.handle);
+            unload(xlib.shm.handle);
             unload(xlib.xcursor.handle);
             unload(xlib.handle);
         }
@@ -268,34 +321,74 @@ namespace awin::platform::x11
 
     void destroy_platform();
 
-    // X error handler
+    // Report the errors waiting in the XCB event queue, see __os_linux_xcb_events.cpp
+    void process_xcb_errors();
+
+    // Find the label of the error scope that issued the request
+    //
+    inline const char *find_error_scope(unsigned long serial)
+    {
+        if (g_ctx->error_scope_first && serial >= g_ctx->error_scope_first) return g_ctx->error_scope_what;
+        for (const auto &scope : g_ctx->error_scopes)
+            if (serial >= scope.first && serial <= scope.last) return scope.what;
+        return nullptr;
+    }
+
+    // X error handler, installed for the lifetime of the display
     //
     inline int error_handler(Display *display, XErrorEvent *ev)
     {
-        if (g_ctx->display != display) return 0;
+        const char *what = g_ctx->display == display ? find_error_scope(ev->serial) : nullptr;
+        if (!what) return g_ctx->error_handler ? g_ctx->error_handler(display, ev) : 0;
         g_ctx->error_code = ev->error_code;
         char buf[128];
         g_ctx->xlib.XGetErrorText(g_ctx->display, ev->error_code, buf, sizeof(buf));
-        AWIN_LOG_ERROR("X11 Error: code=%d (%s), req=%d.%d, res=0x%lx", ev->error_code, buf, ev->request_code,
-                       ev->minor_code, ev->resourceid);
+        AWIN_LOG_ERROR("X11 Error in %s: code=%d (%s), req=%d.%d, res=0x%lx", what, ev->error_code, buf,
+                       ev->request_code, ev->minor_code, ev->resourceid);
         return 0;
     }
 
-    // Sets the X error handler callback
+    // Opens an error scope: errors of the requests issued until release_error_handler are matched to it by
+    // sequence number
     //
-    inline void grab_error_handler()
+    inline void grab_error_handler(const char *what)
     {
-        assert(g_ctx->error_handler == NULL);
+        assert(g_ctx->error_scope_first == 0);
         g_ctx->error_code = Success;
-        g_ctx->error_handler = g_ctx->xlib.XSetErrorHandler(error_handler);
+        g_ctx->error_scope_first = NextRequest(g_ctx->display);
+        g_ctx->error_scope_what = what;
     }
 
-    inline void release_error_handler()
+    // Closes the error scope without waiting for the server. Errors of requests with a reply are already in
+    // error_code, the others are logged when they arrive. Pass sync to wait for all of them instead.
+    //
+    inline void release_error_handler(bool sync = false)
     {
-        // Synchronize to make sure all commands are processed
-        g_ctx->xlib.XSync(g_ctx->display, False);
-        g_ctx->xlib.XSetErrorHandler(g_ctx->error_handler);
-        g_ctx->error_handler = NULL;
+        const unsigned long last = NextRequest(g_ctx->display) - 1;
+        if (sync)
+        {
+            g_ctx->xlib.XSync(g_ctx->display, False);
+            if (g_ctx->xcb_owns_events) process_xcb_errors();
+        }
+
+        // Scopes up to the last processed request can no longer receive errors
+        const unsigned long processed = LastKnownRequestProcessed(g_ctx->display);
+        acul::vector<ErrorScope> &scopes = g_ctx->error_scopes;
+        for (size_t i = scopes.size(); i-- > 0;)
+            if (scopes[i].last <= processed) scopes.erase(scopes.begin() + i);
+        if (last >= g_ctx->error_scope_first && last > processed)
+            scopes.push_back({g_ctx->error_scope_first, last, g_ctx->error_scope_what});
+        g_ctx->error_scope_first = 0;
+    }
+
+    // Send the queued requests, or leave them for the end of the open batch
+    //
+    inline void flush_requests()
+    {
+        if (g_ctx->batch_depth > 0)
+            g_ctx->flush_pending = true;
+        else
+            g_ctx->xlib.XFlush(g_ctx->display);
     }
 
     inline unsigned long get_window_property(XID window, Atom property, Atom type, unsigned char **value)
@@ -313,6 +406,11 @@ namespace awin::platform::x11
     void init_pcall_data(LinuxPlatformCaller &caller);
     void init_wcall_data(LinuxWindowCaller &caller);
 
+    void init_scall_data(LinuxSoftwareCaller &caller);
+
+    // Mark the buffer the server finished reading as free, see __os_linux_software.cpp
+    void on_shm_completion(const XShmCompletionEvent *event);
+
     void init_ccall_data(LinuxCursorCaller &caller);
     Cursor::Platform *create_cursor(Cursor::Type);
     void assign_cursor(Window *, Cursor::Platform *);
@@ -18,6 +18,11 @@ namespace awin
                 XIC ic;
                 Colormap colormap;
                 acul::point2D<int> window_pos;
+                acul::point2D<i32> cursor_pos{0, 0}; // Last pointer position reported by the events of the window.
+                bool cursor_pos_known = false;
+                acul::string title;       // Last value of _NET_WM_NAME, valid while title_known is set.
+                u32 own_title_writes = 0; // _NET_WM_NAME changes of set_window_title not yet notified.
+                bool title_known = false;
                 // The time of the last KeyPress event per keycode, for discarding
                 // duplicate key events generated for some keys by ibus
                 Time key_press_times[256] = {0};
@@ -33,6 +38,21 @@ namespace awin
 
             bool wait_for_x11_event(f64 *timeout);
 
+            // Process the specified X event
+            void process_event(XEvent *event);
+
+            // Update the cursor position of the window from a pointer event
+            void on_cursor_motion(X11WindowData *window_data, acul::point2D<i32> position);
+
+            // Event queue access for both the Xlib and the XCB event paths
+            bool init_xcb_events();
+            void release_xcb_events();
+            void process_xcb_events();
+            bool has_queued_events();
+            bool check_if_event(XEvent *event, Bool (*predicate)(Display *, XEvent *, XPointer), XPointer arg);
+            bool check_typed_window_event(::Window window, int type, XEvent *event);
+            bool peek_queued_event(XEvent *event);
+
             void show_window(WindowData *window_data);
             void hide_window(WindowData *window_data);
 
@@ -43,6 +63,7 @@ namespace awin
             void disable_fullscreen(WindowData *window_data);
 
             acul::point2D<i32> get_cursor_position(WindowData *window_data);
+            acul::point2D<i32> query_cursor_position(WindowData *window_data);
             void set_cursor_position(WindowData *window_data, acul::point2D<i32> position);
 
             void hide_cursor(WindowData *window_data);
@@ -59,9 +80,11 @@ namespace awin
             void destroy(WindowData *);
 
             void poll_events();
+            void begin_batch();
+            void end_batch();
             void wait_events();
-            void wait_events_timeout();
-            void push_empty_event();
+            void wait_events_timeout(f64 timeout);
+            void get_event_fds(acul::vector<int> &fds);
 
             f32 get_dpi(WindowData *);
             acul::point2D<i32> get_window_size(const Window &window);
@@ -0,0 +1,68 @@
+#include <awin/headless.hpp>
+#include <awin/window.hpp>
+#include <thread>
+
+void test_event_thread()
+{
+    acul::events::dispatcher ed;
+    awin::InitConfig config;
+    config.events_dispatcher = &ed;
+    config.backend = WINDOW_BACKEND_HEADLESS;
+    config.event_thread = true;
+
+    awin::init_library(config);
+    awin::Window window("Threaded Window", 640, 480);
+    assert(awin::get_window_size(window) == acul::point2D<i32>(640, 480));
+
+    // Commands run in order on the event thread
+    window.title("Renamed");
+    assert(window.title() == "Renamed");
+
+    int key_events = 0;
+    std::thread::id listener_thread;
+    ed.bind_event(&key_events, awin::event_id::key_input, [&](awin::KeyInputEvent &) {
+        ++key_events;
+        listener_thread = std::this_thread::get_id();
+    });
+    awin::update_events();
+
+    for (int i = 0; i < 4; ++i)
+        awin::headless::inject_key(window, awin::io::Key::a,
+                                   (i & 1) ? awin::io::KeyPressState::release : awin::io::KeyPressState::press);
+    while (key_events < 4) awin::wait_events();
+    assert(listener_thread == std::this_thread::get_id());
+
+    awin::push_empty_event();
+    awin::wait_events();
+
+    // Events of a destroyed window are dropped, including those that did not fit into the queue
+    awin::Window flooded("Flooded Window", 320, 240);
+    int stale_events = 0;
+    ed.bind_event(&stale_events, awin::event_id::mouse_move, [&](awin::PosEvent &event) {
+        if (event.window == &flooded) ++stale_events;
+    });
+    awin::update_events();
+    for (int i = 0; i < 10000; ++i) awin::headless::inject_cursor_pos(flooded, {i % 320, i % 240});
+    while (awin::headless::pending_events() > 0) std::this_thread::yield();
+    flooded.destroy();
+    for (int i = 0; i < 4; ++i)
+    {
+        awin::push_empty_event();
+        awin::wait_events();
+    }
+    assert(stale_events == 0);
+
+    // The window state is published along with the events and seen once a poll delivers it
+    awin::headless::inject_resize(window, {800, 600});
+    while (awin::headless::pending_events() > 0) std::this_thread::yield();
+    while (!(window.dimensions() == acul::point2D<i32>(800, 600))) awin::wait_events();
+    window.ready_to_close(true);
+    assert(window.ready_to_close());
+    window.ready_to_close(false);
+    assert(!window.ready_to_close());
+
+    awin::headless::inject_close(window);
+    while (!window.ready_to_close()) awin::wait_events();
+    window.destroy();
+    awin::destroy_library();
+}
@@ -0,0 +1,261 @@
+#include <algorithm>
+#include <awin/headless.hpp>
+#include <awin/native_access.hpp>
+#include <awin/software.hpp>
+#include <awin/trace.hpp>
+#include <awin/window.hpp>
+#include <poll.h>
+#include <unistd.h>
+
+void test_headless()
+{
+    acul::events::dispatcher ed;
+    awin::InitConfig config;
+    config.events_dispatcher = &ed;
+    config.backend = WINDOW_BACKEND_HEADLESS;
+
+    awin::init_library(config);
+    assert(awin::native_access::get_backend_type() == WINDOW_BACKEND_HEADLESS);
+    const u64 time_ns = awin::get_time_ns();
+    const f64 time = awin::get_time();
+    assert(time >= time_ns * 1e-9 && time - time_ns * 1e-9 < 1.0);
+    awin::Window window("Headless Window", 640, 480);
+    assert(awin::get_window_size(window) == acul::point2D<i32>(640, 480));
+
+    int key_presses = 0;
+    int moves = 0;
+    acul::point2D<i32> last_pos;
+    ed.bind_event(&key_presses, awin::event_id::key_input, [&](awin::KeyInputEvent &event) {
+        assert(event.dispatch_time > 0.0 && event.server_time == 0);
+        if (event.window == &window && event.key == awin::io::Key::a && event.action == awin::io::KeyPressState::press)
+            ++key_presses;
+    });
+    ed.bind_event(&moves, awin::event_id::mouse_move, [&](awin::PosEvent &event) {
+        ++moves;
+        last_pos = event.position;
+    });
+    awin::update_events();
+
+    awin::headless::inject_key(window, awin::io::Key::a, awin::io::KeyPressState::press);
+    awin::headless::inject_cursor_pos(window, {10, 10});
+    awin::headless::inject_cursor_pos(window, {20, 30});
+    assert(awin::headless::pending_events() == 3);
+    awin::poll_events();
+    assert(awin::headless::pending_events() == 0);
+    assert(key_presses == 1 && moves == 2 && last_pos == acul::point2D<i32>(20, 30));
+    {
+        const awin::InputSnapshot &input = awin::get_input_snapshot(window);
+        assert(input.key_pressed(awin::io::Key::a) && input.key_down(awin::io::Key::a) && input.any_key_down());
+        assert(!input.key_released(awin::io::Key::a) && input.cursor_pos == acul::point2D<i32>(20, 30));
+    }
+
+    // Consecutive motion is merged into one event when coalescing is enabled
+    awin::set_event_coalescing(awin::CoalesceBits::mouse_move);
+    for (int i = 0; i < 8; ++i) awin::headless::inject_cursor_pos(window, {i, i});
+    awin::poll_events();
+    assert(moves == 3 && last_pos == acul::point2D<i32>(7, 7));
+
+    // Held-back motion is delivered before a leave that follows it in the same cycle
+    bool left_after_motion = false;
+    ed.bind_event(&left_after_motion, awin::event_id::mouse_enter, [&](awin::MouseEnterEvent &event) {
+        if (!event.entered) left_after_motion = moves == 4 && last_pos == acul::point2D<i32>(50, 60);
+    });
+    awin::update_events();
+    awin::headless::inject_mouse_enter(window, true);
+    awin::headless::inject_cursor_pos(window, {50, 60});
+    awin::headless::inject_mouse_enter(window, false);
+    awin::poll_events();
+    assert(left_after_motion && moves == 4);
+
+    // Resizes are reported once per cycle with the final size, and the end of a live resize delivers it first
+    int resizes = 0;
+    acul::point2D<i32> last_size;
+    acul::vector<bool> live_states;
+    ed.bind_event(&resizes, awin::event_id::resize, [&](awin::PosEvent &event) {
+        ++resizes;
+        last_size = event.position;
+    });
+    ed.bind_event(&live_states, awin::event_id::live_resize, [&](awin::StateEvent &event) {
+        assert(event.state || last_size == acul::point2D<i32>(900, 700));
+        live_states.push_back(event.state);
+    });
+    awin::update_events();
+    awin::set_event_coalescing(awin::CoalesceBits::mouse_move | awin::CoalesceBits::resize);
+    awin::headless::inject_live_resize(window, true);
+    for (int i = 1; i <= 10; ++i) awin::headless::inject_resize(window, {640 + i * 10, 480 + i * 10});
+    awin::poll_events();
+    assert(resizes == 1 && last_size == acul::point2D<i32>(740, 580));
+    awin::headless::inject_resize(window, {900, 700});
+    awin::headless::inject_live_resize(window, false);
+    awin::poll_events();
+    assert(resizes == 2 && live_states.size() == 2 && live_states[0] && !live_states[1]);
+    awin::set_event_coalescing(awin::CoalesceBits::mouse_move);
+
+    // Per-cycle state is cleared by the next poll, held keys and buttons are kept
+    awin::headless::inject_mouse_click(window, awin::io::MouseKey::left, awin::io::KeyPressState::press);
+    awin::headless::inject_scroll(window, 0.0f, 1.0f);
+    awin::headless::inject_scroll(window, 0.0f, 2.0f);
+    awin::poll_events();
+    {
+        const awin::InputSnapshot &input = awin::get_input_snapshot(window);
+        assert(!input.key_pressed(awin::io::Key::a) && input.key_down(awin::io::Key::a));
+        assert(input.button_pressed(awin::io::MouseKey::left) && input.scroll.y == 3.0f);
+    }
+    awin::poll_events();
+    {
+        const awin::InputSnapshot &input = awin::get_input_snapshot(window);
+        assert(!input.button_pressed(awin::io::MouseKey::left) && input.button_down(awin::io::MouseKey::left));
+        assert(input.scroll.y == 0.0f);
+    }
+
+    // Recorded events are replayed through the same listeners
+    awin::trace::Recorder recorder;
+    recorder.start();
+    awin::headless::inject_key(window, awin::io::Key::a, awin::io::KeyPressState::release);
+    awin::headless::inject_key(window, awin::io::Key::a, awin::io::KeyPressState::press);
+    awin::headless::inject_live_resize(window, true);
+    awin::headless::inject_live_resize(window, false);
+    awin::poll_events();
+    recorder.stop();
+    assert(key_presses == 2 && live_states.size() == 4);
+
+    awin::trace::Replayer replayer;
+    const bool loaded = replayer.load(recorder.data());
+    assert(loaded);
+    replayer.start({&window}, false);
+    while (replayer.update()) {}
+    assert(replayer.finished() && key_presses == 3 && live_states.size() == 6 && live_states[4] && !live_states[5]);
+
+    // Batched events reach the listeners of each type and then the batch listeners, once per type
+    size_t batched_keys = 0;
+    ed.bind_event(&batched_keys, awin::event_id::batch, [&](awin::EventBatch &batch) {
+        if (batch.type == awin::event_id::key_input) batched_keys += batch.events<awin::KeyInputEvent>().size();
+    });
+    awin::update_events();
+    awin::set_event_batching(true);
+    awin::headless::inject_key(window, awin::io::Key::a, awin::io::KeyPressState::release);
+    awin::headless::inject_key(window, awin::io::Key::a, awin::io::KeyPressState::press);
+    awin::poll_events();
+    awin::set_event_batching(false);
+    assert(key_presses == 4 && batched_keys == 2);
+
+    // A window destroyed by a listener during batched delivery gets none of its remaining events
+    awin::Window doomed("Doomed Window", 320, 240);
+    int doomed_keys = 0;
+    bool doomed_destroyed = false;
+    ed.bind_event(&doomed_keys, awin::event_id::key_input, [&](awin::KeyInputEvent &event) {
+        if (event.window == &doomed)
+            ++doomed_keys;
+        else if (event.key == awin::io::Key::c && !doomed_destroyed)
+        {
+            doomed.destroy();
+            doomed_destroyed = true;
+        }
+    });
+    awin::update_events();
+    awin::set_event_batching(true);
+    awin::headless::inject_key(window, awin::io::Key::c, awin::io::KeyPressState::press);
+    awin::headless::inject_key(doomed, awin::io::Key::c, awin::io::KeyPressState::press);
+    awin::poll_events();
+    awin::set_event_batching(false);
+    assert(doomed_destroyed && doomed_keys == 0 && batched_keys == 3);
+
+    // Watched descriptors wake the wait and their callbacks run in the poll cycle
+    int watch_pipe[2];
+    const bool piped = pipe(watch_pipe) == 0;
+    assert(piped);
+    int watch_calls = 0;
+    const bool watched = awin::add_fd_watch(
+        watch_pipe[0], POLLIN,
+        [](int fd, i16 revents, void *user_data) {
+            char byte;
+            if ((revents & POLLIN) && read(fd, &byte, 1) == 1) ++*static_cast<int *>(user_data);
+        },
+        &watch_calls);
+    assert(watched && !awin::add_fd_watch(watch_pipe[0], POLLIN, nullptr));
+    const char byte = 1;
+    const ssize_t written = write(watch_pipe[1], &byte, 1);
+    assert(written == 1);
+    awin::wait_events();
+    assert(watch_calls == 1);
+    awin::remove_fd_watch(watch_pipe[0]);
+    close(watch_pipe[0]);
+    close(watch_pipe[1]);
+
+    // The event descriptor is readable while injected events wait to be processed
+    pollfd event_fd = {awin::get_event_fd(), POLLIN, 0};
+    awin::headless::inject_key(window, awin::io::Key::b, awin::io::KeyPressState::press);
+    const int ready = poll(&event_fd, 1, 0);
+    awin::poll_events();
+    const int drained = poll(&event_fd, 1, 0);
+    assert(ready == 1 && drained == 0);
+
+    // Wakeups from push_empty_event are coalesced and consumed by the next poll
+    for (int i = 0; i < 1000; ++i) awin::push_empty_event();
+    const int woken = poll(&event_fd, 1, 0);
+    awin::wait_events();
+    const int consumed = poll(&event_fd, 1, 0);
+    assert(woken == 1 && consumed == 0);
+
+    // Timers wake the wait and fire in the poll cycle, periodic timers keep firing until stopped
+    int once_fired = 0;
+    int periodic_fired = 0;
+    auto count_fired = [](awin::Timer &, void *count) { ++*static_cast<int *>(count); };
+    awin::Timer once(count_fired, &once_fired);
+    awin::Timer periodic(count_fired, &periodic_fired);
+    const f64 start = awin::get_time();
+    once.start_once(0.02);
+    periodic.start_periodic(0.005);
+    while (once_fired == 0) awin::wait_events();
+    assert(awin::get_time() - start >= 0.02 && !once.active() && periodic.active() && periodic_fired >= 1);
+    periodic.stop();
+    assert(!periodic.active());
+
+    // A deadline wait without events returns once the deadline has passed
+    const f64 deadline = awin::get_time() + 0.01;
+    awin::wait_events_until(deadline);
+    assert(awin::get_time() >= deadline && once_fired == 1);
+
+    awin::set_clipboard_string(window, "headless");
+    assert(awin::get_clipboard_string(window) == "headless");
+
+    // Software surfaces hand out the oldest buffer, only the damaged pixels of a present reach the window
+    {
+        awin::SoftwareSurface surface(window, 2);
+        assert(surface.valid() && awin::headless::get_presented_frame(window).empty());
+        awin::SoftwareSurface::Buffer buffer;
+        const bool acquired = surface.acquire(buffer);
+        assert(acquired && buffer.age == 0 && buffer.size == acul::point2D<i32>(900, 700) && buffer.stride == 900);
+        std::fill(buffer.pixels, buffer.pixels + buffer.stride * buffer.size.y, 0xFF0000FFu);
+        surface.present();
+
+        const bool reacquired = surface.acquire(buffer);
+        assert(reacquired && buffer.age == 0);
+        std::fill(buffer.pixels, buffer.pixels + buffer.stride * buffer.size.y, 0xFFFF0000u);
+        const awin::DamageRect rect{10, 20, 30, 40};
+        surface.present({&rect, 1});
+
+        acul::point2D<i32> frame_size;
+        const std::span<const u32> frame = awin::headless::get_presented_frame(window, &frame_size);
+        assert(frame_size == acul::point2D<i32>(900, 700) && frame.size() == 900 * 700);
+        assert(frame[20 * 900 + 10] == 0xFFFF0000u && frame[59 * 900 + 39] == 0xFFFF0000u);
+        assert(frame[0] == 0xFF0000FFu && frame[60 * 900 + 10] == 0xFF0000FFu);
+
+        // The first buffer holds the frame before the previous one
+        const bool third = surface.acquire(buffer);
+        assert(third && buffer.age == 2 && buffer.pixels[0] == 0xFF0000FFu);
+
+        // Damage outside the buffer or with a negative extent is ignored
+        std::fill(buffer.pixels, buffer.pixels + buffer.stride * buffer.size.y, 0xFF00FF00u);
+        const awin::DamageRect outside[] = {{1000, 0, 10, 10}, {0, 800, 10, 10}, {5, 5, -3, 10}, {5, 5, 10, -3}};
+        surface.present(outside);
+        const std::span<const u32> unchanged = awin::headless::get_presented_frame(window);
+        assert(unchanged[0] == 0xFF0000FFu && unchanged[5 * 900 + 5] == 0xFF0000FFu);
+        assert(unchanged[20 * 900 + 10] == 0xFFFF0000u);
+    }
+
+    awin::headless::inject_close(window);
+    while (!window.ready_to_close()) awin::poll_events();
+    window.destroy();
+    awin::destroy_library();
+}